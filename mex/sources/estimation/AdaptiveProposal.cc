@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+///////////////////////////////////////////////////////////
+//  AdaptiveProposal.cc
+//  Implementation of the Class AdaptiveProposal
+///////////////////////////////////////////////////////////
+
+#include <cmath>
+
+#include "AdaptiveProposal.hh"
+
+AdaptiveProposal::AdaptiveProposal(const VectorConstView &vJscale, const MatrixConstView &covariance,
+                                   double targetAcceptance_arg, double decay_arg, double offset_arg) :
+  Proposal(vJscale, covariance),
+  targetAcceptance(targetAcceptance_arg), decay(decay_arg), offset(offset_arg),
+  jscale(len), initialFactor(len), runningMean(len), deviation(len), step(len),
+  logJumpScale(0), nAdaptations(0)
+{
+  assert(decay > 0.5 && decay <= 1);
+  jscale = vJscale;
+  initialFactor = covarianceCholeskyDecomposition;
+}
+
+void
+AdaptiveProposal::restart()
+{
+  covarianceCholeskyDecomposition = initialFactor;
+  logJumpScale = 0;
+  nAdaptations = 0;
+}
+
+void
+AdaptiveProposal::setChain(size_t newChain)
+{
+  Proposal::setChain(newChain);
+  restart();
+}
+
+void
+AdaptiveProposal::rescale(const Vector &scale)
+{
+  restart();
+  Proposal::rescale(scale);
+  initialFactor = covarianceCholeskyDecomposition;
+}
+
+void
+AdaptiveProposal::fillNormals(uint64_t start)
+{
+  // The buffer holds the raw normal numbers, since the factor changes at every step
+  for (size_t k = 0; k < bufferSize; k++)
+    drawStream.fillNormals(chain, start + k, innovations.getData() + k*innovations.getLd(), len);
+  innovationsStart = start;
+  innovationsValid = true;
+}
+
+void
+AdaptiveProposal::draw(Vector &mean, Vector &draw)
+{
+  assert(len == draw.getSize());
+  assert(len == mean.getSize());
+
+  if (!innovationsValid || drawIndex < innovationsStart || drawIndex >= innovationsStart + bufferSize)
+    fillNormals(drawIndex);
+
+  step = mat::get_col(innovations, (size_t) (drawIndex - innovationsStart));
+  blas::trmv("U", "T", "N", covarianceCholeskyDecomposition, step);
+  const double jumpScale = exp(logJumpScale);
+  for (size_t i = 0; i < len; i++)
+    draw(i) = mean(i) + jumpScale*step(i);
+  drawIndex++;
+}
+
+void
+AdaptiveProposal::adapt(const Vector &state, bool accepted)
+{
+  assert(len == state.getSize());
+  const double gamma = pow(nAdaptations + offset, -decay);
+  if (nAdaptations == 0)
+    runningMean = state;
+  else
+    {
+      // Sigma <- (1-gamma)*Sigma + gamma*J*d*d'*J, with d the deviation from the previous mean
+      const double shrink = sqrt(1 - gamma), weight = sqrt(gamma);
+      for (size_t i = 0; i < len; i++)
+        {
+          double d = state(i) - runningMean(i);
+          deviation(i) = weight*jscale(i)*d;
+          runningMean(i) += gamma*d;
+        }
+      for (size_t j = 0; j < len; j++)
+        for (size_t i = 0; i <= j; i++)
+          covarianceCholeskyDecomposition(i, j) *= shrink;
+      choleskyUpdate(covarianceCholeskyDecomposition, deviation);
+    }
+  logJumpScale += gamma*((accepted ? 1.0 : 0.0) - targetAcceptance);
+  nAdaptations++;
+}
+
+void
+AdaptiveProposal::choleskyUpdate(Matrix &R, Vector &x)
+{
+  const size_t n = R.getRows();
+  assert(R.getCols() == n && x.getSize() == n);
+  // Sequence of Givens rotations, row by row of R
+  for (size_t k = 0; k < n; k++)
+    {
+      double r = sqrt(R(k, k)*R(k, k) + x(k)*x(k));
+      double c = r/R(k, k), s = x(k)/R(k, k);
+      R(k, k) = r;
+      for (size_t j = k+1; j < n; j++)
+        {
+          R(k, j) = (R(k, j) + s*x(j))/c;
+          x(j) = c*x(j) - s*R(k, j);
+        }
+    }
+}
+
+bool
+AdaptiveProposal::choleskyDowndate(Matrix &R, Vector &x)
+{
+  const size_t n = R.getRows();
+  assert(R.getCols() == n && x.getSize() == n);
+  // Hyperbolic rotations; on failure, R is left partially modified
+  for (size_t k = 0; k < n; k++)
+    {
+      double r2 = R(k, k)*R(k, k) - x(k)*x(k);
+      if (r2 <= 0)
+        return false;
+      double r = sqrt(r2);
+      double c = r/R(k, k), s = x(k)/R(k, k);
+      R(k, k) = r;
+      for (size_t j = k+1; j < n; j++)
+        {
+          R(k, j) = (R(k, j) - s*x(j))/c;
+          x(j) = c*x(j) - s*R(k, j);
+        }
+    }
+  return true;
+}
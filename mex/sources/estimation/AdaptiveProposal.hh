@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+///////////////////////////////////////////////////////////
+//  AdaptiveProposal.hh
+//  Implementation of the Class AdaptiveProposal
+///////////////////////////////////////////////////////////
+
+#if !defined(AP_4E7A2C91_D35B_4F08_9A6E_1C8B72F0D354__INCLUDED_)
+#define AP_4E7A2C91_D35B_4F08_9A6E_1C8B72F0D354__INCLUDED_
+
+#include "Proposal.hh"
+
+/**
+ * Adaptive Metropolis proposal (Haario et al., 2001), in the stochastic
+ * approximation form of Andrieu and Thoms (2008): after each step n of the
+ * chain, with weight gamma = (n + offset)^(-decay),
+ * - the running mean and covariance of the states are updated, and the
+ *   proposal covariance becomes (1-gamma)*Sigma + gamma*J*d*d'*J, where d is
+ *   the deviation of the state from the running mean and J = diag(jscale);
+ *   its Cholesky factor is updated in O(n^2) by a rank-one update, instead of
+ *   being refactored;
+ * - the log of the jump scale moves by gamma*(accepted - targetAcceptance),
+ *   so that the acceptance rate converges to its target.
+ *
+ * Since gamma vanishes, the adaptation diminishes and the chain remains
+ * ergodic. The proposal starts from the covariance given to the constructor,
+ * and restarts from it when another chain is selected.
+ */
+class AdaptiveProposal : public Proposal
+{
+public:
+  AdaptiveProposal(const VectorConstView &vJscale, const MatrixConstView &covariance,
+                   double targetAcceptance_arg = 0.234, double decay_arg = 0.6, double offset_arg = 100);
+  virtual ~AdaptiveProposal()
+  {
+  };
+  virtual Proposal *
+  clone() const
+  {
+    return new AdaptiveProposal(*this);
+  };
+
+  virtual void draw(Vector &mean, Vector &draw);
+  virtual void adapt(const Vector &state, bool accepted);
+  virtual void setChain(size_t chain);
+  virtual void rescale(const Vector &scale);
+  //! Forgets the adaptation made so far
+  void restart();
+
+  double
+  getJumpScale() const
+  {
+    return exp(logJumpScale);
+  };
+  size_t
+  getAdaptations() const
+  {
+    return nAdaptations;
+  };
+
+  //! Rank-one update of an upper triangular Cholesky factor: R'*R becomes R'*R + x*x' (x is overwritten)
+  static void choleskyUpdate(Matrix &R, Vector &x);
+  //! Rank-one downdate: R'*R becomes R'*R - x*x'; returns false if the result is not positive definite
+  static bool choleskyDowndate(Matrix &R, Vector &x);
+
+private:
+  const double targetAcceptance, decay, offset;
+  Vector jscale;
+  //! Factor at the start of the adaptation
+  Matrix initialFactor;
+  Vector runningMean, deviation, step;
+  double logJumpScale;
+  size_t nAdaptations;
+
+  void fillNormals(uint64_t start);
+};
+
+#endif // !defined(AP_4E7A2C91_D35B_4F08_9A6E_1C8B72F0D354__INCLUDED_)
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+///////////////////////////////////////////////////////////
+//  BlockDecomposition.cc
+//  Implementation of the Class BlockDecomposition
+///////////////////////////////////////////////////////////
+
+#include <algorithm>
+
+#include "BlockDecomposition.hh"
+
+namespace
+{
+  const size_t unmatched = (size_t) -1;
+}
+
+size_t
+BlockDecomposition::getMaxBlockSize() const
+{
+  size_t m = 0;
+  for (size_t b = 0; b < blockEquations.size(); b++)
+    m = std::max(m, blockEquations[b].size());
+  return m;
+}
+
+bool
+BlockDecomposition::augment(size_t eq, size_t mark)
+{
+  const std::vector<size_t> &vars = equationVariables[eq];
+  for (size_t k = 0; k < vars.size(); k++)
+    {
+      size_t v = vars[k];
+      if (visitMark[v] == mark)
+        continue;
+      visitMark[v] = mark;
+      if (variableMatch[v] == unmatched || augment(variableMatch[v], mark))
+        {
+          variableMatch[v] = eq;
+          equationMatch[eq] = v;
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+BlockDecomposition::strongConnect(size_t eq)
+{
+  index[eq] = lowlink[eq] = counter++;
+  stack.push_back(eq);
+  onStack[eq] = true;
+
+  // Equation eq depends on the equations whose matched variables appear in it
+  const std::vector<size_t> &vars = equationVariables[eq];
+  for (size_t k = 0; k < vars.size(); k++)
+    {
+      size_t succ = variableMatch[vars[k]];
+      if (index[succ] == unmatched)
+        {
+          strongConnect(succ);
+          lowlink[eq] = std::min(lowlink[eq], lowlink[succ]);
+        }
+      else if (onStack[succ])
+        lowlink[eq] = std::min(lowlink[eq], index[succ]);
+    }
+
+  // Components are completed after all the components they depend on, i.e. in solving order
+  if (lowlink[eq] == index[eq])
+    {
+      blockEquations.push_back(std::vector<size_t>());
+      blockVariables.push_back(std::vector<size_t>());
+      size_t e;
+      do
+        {
+          e = stack.back();
+          stack.pop_back();
+          onStack[e] = false;
+          blockEquations.back().push_back(e);
+          blockVariables.back().push_back(equationMatch[e]);
+        }
+      while (e != eq);
+    }
+}
+
+bool
+BlockDecomposition::computeImpl()
+{
+  blockEquations.clear();
+  blockVariables.clear();
+
+  variableMatch.assign(n, unmatched);
+  equationMatch.assign(n, unmatched);
+  visitMark.assign(n, unmatched);
+  for (size_t eq = 0; eq < n; eq++)
+    if (!augment(eq, eq))
+      return false;
+
+  index.assign(n, unmatched);
+  lowlink.assign(n, 0);
+  onStack.assign(n, false);
+  stack.clear();
+  counter = 0;
+  for (size_t eq = 0; eq < n; eq++)
+    if (index[eq] == unmatched)
+      strongConnect(eq);
+
+  return true;
+}
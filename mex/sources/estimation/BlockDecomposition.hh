@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+///////////////////////////////////////////////////////////
+//  BlockDecomposition.hh
+//  Implementation of the Class BlockDecomposition
+///////////////////////////////////////////////////////////
+
+#if !defined(BD_6F1D3A80_2C9E_4B57_8E4A_D05B7C19F362__INCLUDED_)
+#define BD_6F1D3A80_2C9E_4B57_8E4A_D05B7C19F362__INCLUDED_
+
+#include <cstdlib>
+#include <cassert>
+#include <vector>
+
+/**
+ * Block-triangular decomposition of a square system of equations, computed
+ * from the sparsity pattern of its jacobian.
+ *
+ * Each equation is first matched with a variable (maximum bipartite
+ * matching, i.e. the square part of the Dulmage-Mendelsohn decomposition);
+ * then the strongly connected components of the dependency graph between
+ * equations (Tarjan's algorithm) give the blocks. Blocks are numbered in
+ * solving order: the equations of a block only involve the variables of
+ * this block and of the previous ones.
+ */
+class BlockDecomposition
+{
+public:
+  BlockDecomposition() : n(0)
+  {
+  };
+  virtual ~BlockDecomposition()
+  {
+  };
+
+  /**
+   * Computes the blocks from the nonzero entries of the jacobian (equations in rows, variables in columns).
+   * \return false if the system is structurally singular, in which case there is no decomposition
+   */
+  template<class Mat>
+  bool
+  compute(const Mat &jacobian)
+  {
+    assert(jacobian.getRows() == jacobian.getCols());
+    n = jacobian.getRows();
+    equationVariables.assign(n, std::vector<size_t>());
+    for (size_t j = 0; j < n; j++)
+      for (size_t i = 0; i < n; i++)
+        if (jacobian(i, j) != 0.0)
+          equationVariables[i].push_back(j);
+    return computeImpl();
+  };
+
+  size_t
+  getNumBlocks() const
+  {
+    return blockEquations.size();
+  };
+  //! Equations of a block, in the same order as its variables (i-th equation matched with i-th variable)
+  const std::vector<size_t> &
+  getEquations(size_t block) const
+  {
+    return blockEquations[block];
+  };
+  const std::vector<size_t> &
+  getVariables(size_t block) const
+  {
+    return blockVariables[block];
+  };
+  size_t getMaxBlockSize() const;
+
+private:
+  size_t n;
+  //! Sparsity pattern: the variables of each equation
+  std::vector<std::vector<size_t> > equationVariables;
+  std::vector<std::vector<size_t> > blockEquations, blockVariables;
+
+  // Work arrays of the matching and SCC algorithms
+  std::vector<size_t> variableMatch, equationMatch, visitMark;
+  std::vector<size_t> index, lowlink, stack;
+  std::vector<bool> onStack;
+  size_t counter;
+
+  bool computeImpl();
+  //! Looks for an augmenting path starting from an equation (Kuhn's algorithm)
+  bool augment(size_t eq, size_t mark);
+  void strongConnect(size_t eq);
+};
+
+#endif // !defined(BD_6F1D3A80_2C9E_4B57_8E4A_D05B7C19F362__INCLUDED_)
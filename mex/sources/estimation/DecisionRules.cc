@@ -40,11 +40,11 @@ DecisionRules::DecisionRules(size_t n_arg, size_t p_arg,
   D(n_fwrd + n_back + 2*n_mixed),
   E(n_fwrd + n_back + 2*n_mixed),
   Z_prime(n_fwrd + n_back + 2*n_mixed),
-  QR(n, n_static, n_back_mixed + n + n_fwrd_mixed),
-  GSD(n_fwrd + n_back + 2*n_mixed, qz_criterium),
-  LU1(n_fwrd_mixed),
-  LU2(n_back_mixed),
-  LU3(n_static),
+  QR(n, n_static, n_back_mixed + n + n_fwrd_mixed, workspace),
+  GSD(n_fwrd + n_back + 2*n_mixed, qz_criterium, workspace),
+  LU1(n_fwrd_mixed, workspace),
+  LU2(n_back_mixed, workspace),
+  LU3(n_static, workspace),
   Z21(n_fwrd_mixed, n_back_mixed),
   g_y_back(n_back_mixed),
   g_y_back_tmp(n_back_mixed),
@@ -55,10 +55,16 @@ DecisionRules::DecisionRules(size_t n_arg, size_t p_arg,
   g_y_static_tmp(n_fwrd_mixed, n_back_mixed),
   g_u_tmp1(n, n_back_mixed),
   g_u_tmp2(n),
-  LU4(n)
+  LU4(n, workspace),
+  D_const(n_fwrd + n_back + 2*n_mixed),
+  E_const(n_fwrd + n_back + 2*n_mixed),
+  constant_jacobian(n, n_back_mixed + n + n_fwrd_mixed + p)
 {
   assert(n == n_back + n_fwrd + n_mixed + n_static);
 
+  // All decompositions have made their reservations
+  workspace.allocate();
+
   set_union(zeta_fwrd.begin(), zeta_fwrd.end(),
             zeta_mixed.begin(), zeta_mixed.end(),
             back_inserter(zeta_fwrd_mixed));
@@ -84,45 +90,229 @@ DecisionRules::DecisionRules(size_t n_arg, size_t p_arg,
       pi_fwrd.push_back(i);
     else
       beta_fwrd.push_back(i);
+
+  initPencilMaps();
 }
 
 void
-DecisionRules::compute(const Matrix &jacobian, Matrix &g_y, Matrix &g_u) throw (BlanchardKahnException, GeneralizedSchurDecomposition::GSDException)
+DecisionRules::initPencilMaps()
+{
+  static_QR_cached = static_LU_cached = false;
+  constant_cols_list.clear();
+
+  D_cols_src.clear();
+  D_cols_dest.clear();
+  for (size_t j = 0; j < n_back_mixed; j++)
+    {
+      D_cols_src.push_back(n_back_mixed + zeta_back_mixed[j]);
+      D_cols_dest.push_back(j);
+    }
+  for (size_t j = 0; j < n_fwrd_mixed; j++)
+    {
+      D_cols_src.push_back(n_back_mixed + n + j);
+      D_cols_dest.push_back(n_back_mixed + j);
+    }
+
+  E_cols_src.clear();
+  E_cols_dest.clear();
+  for (size_t j = 0; j < n_back_mixed; j++)
+    {
+      E_cols_src.push_back(j);
+      E_cols_dest.push_back(j);
+    }
+  for (size_t j = 0; j < n_fwrd; j++)
+    {
+      E_cols_src.push_back(n_back_mixed + zeta_fwrd_mixed[pi_fwrd[j]]);
+      E_cols_dest.push_back(n_back_mixed + pi_fwrd[j]);
+    }
+
+  D_const.setAll(0.0);
+  for (size_t i = 0; i < n_mixed; i++)
+    D_const(n - n_static + i, beta_back[i]) = 1.0;
+
+  E_const.setAll(0.0);
+  for (size_t i = 0; i < n_mixed; i++)
+    E_const(n - n_static + i, n_back_mixed + beta_fwrd[i]) = 1.0;
+}
+
+void
+DecisionRules::setConstantColumns(const Matrix &jacobian, const std::vector<bool> &constant_cols)
 {
   assert(jacobian.getRows() == n
          && jacobian.getCols() == (n_back_mixed + n + n_fwrd_mixed + p));
-  assert(g_y.getRows() == n && g_y.getCols() == n_back_mixed);
-  assert(g_u.getRows() == n && g_u.getCols() == p);
+  assert(constant_cols.size() == jacobian.getCols());
+
+  initPencilMaps();
+
+  bool static_constant = true;
+  for (size_t i = 0; i < n_static; i++)
+    static_constant = static_constant && constant_cols[n_back_mixed + zeta_static[i]];
+
+  // If the static columns vary, so does Q, and nothing can be cached
+  if (!static_constant)
+    return;
+
+  constant_jacobian = jacobian;
+  for (size_t j = 0; j < constant_cols.size(); j++)
+    if (constant_cols[j])
+      constant_cols_list.push_back(j);
 
-  // Construct S, perform QR decomposition and get A = Q*jacobian
   A = MatrixConstView(jacobian, 0, 0, n, n_back_mixed + n + n_fwrd_mixed);
   if (n_static > 0)
     {
       for (size_t i = 0; i < n_static; i++)
-        mat::col_copy(jacobian, n_back_mixed+zeta_static[i], S, i);
+        mat::col_copy(jacobian, n_back_mixed + zeta_static[i], S, i);
+      QR.compute(S);
+      QR.leftMultByQ(S, "T", A);
+      static_QR_cached = true;
 
-      QR.computeAndLeftMultByQ(S, "T", A);
+      for (size_t i = 0; i < n_static; i++)
+        mat::col_copy(A, n_back_mixed + zeta_static[i], 0, n_static, A0s, i, 0);
+      try
+        {
+          LU3.factorize(A0s);
+          static_LU_cached = true;
+        }
+      catch (LUSolver::LUException &e)
+        {
+          // Will be reported by compute()
+        }
     }
 
-  // Construct matrix D
-  D.setAll(0.0);
-  for (size_t i = 0; i < n_mixed; i++)
-    D(n - n_static + i, beta_back[i]) = 1.0;
-  for (size_t j = 0; j < n_back_mixed; j++)
-    mat::col_copy(A, n_back_mixed + zeta_back_mixed[j], n_static, n - n_static,
-                  D, j, 0);
-  MatrixView(D, 0, n_back_mixed, n - n_static, n_fwrd_mixed) = MatrixView(A, n_static, n_back_mixed + n, n - n_static, n_fwrd_mixed);
+  // Since Q is constant, constant columns of the jacobian give constant columns of A
+  std::vector<size_t> src, dest;
+  for (size_t k = 0; k < D_cols_src.size(); k++)
+    if (constant_cols[D_cols_src[k]])
+      mat::col_copy(A, D_cols_src[k], n_static, n - n_static, D_const, D_cols_dest[k], 0);
+    else
+      {
+        src.push_back(D_cols_src[k]);
+        dest.push_back(D_cols_dest[k]);
+      }
+  D_cols_src.swap(src);
+  D_cols_dest.swap(dest);
 
-  // Construct matrix E
-  E.setAll(0.0);
-  for (size_t i = 0; i < n_mixed; i++)
-    E(n - n_static + i, n_back_mixed + beta_fwrd[i]) = 1.0;
-  MatrixView(E, 0, 0, n - n_static, n_back_mixed) = MatrixView(A, n_static, 0, n - n_static, n_back_mixed);
-  for (size_t j = 0; j < n_fwrd; j++)
-    mat::col_copy(A, n_back_mixed + zeta_fwrd_mixed[pi_fwrd[j]], n_static, n - n_static,
-                  E, n_back_mixed + pi_fwrd[j], 0);
-  MatrixView E_tmp(E, 0, 0, n - n_static, n_fwrd + n_back + 2*n_mixed);
-  mat::negate(E_tmp); // Here we take the opposite of some of the zeros initialized in the constructor, but it is not a problem
+  src.clear();
+  dest.clear();
+  for (size_t k = 0; k < E_cols_src.size(); k++)
+    if (constant_cols[E_cols_src[k]])
+      {
+        mat::col_copy(A, E_cols_src[k], n_static, n - n_static, E_const, E_cols_dest[k], 0);
+        VectorView c(E_const.getData() + E_cols_dest[k]*E_const.getLd(), n - n_static, 1);
+        vec::negate(c);
+      }
+    else
+      {
+        src.push_back(E_cols_src[k]);
+        dest.push_back(E_cols_dest[k]);
+      }
+  E_cols_src.swap(src);
+  E_cols_dest.swap(dest);
+}
+
+bool
+DecisionRules::constantColumnsUnchanged(const Matrix &jacobian) const
+{
+  for (size_t k = 0; k < constant_cols_list.size(); k++)
+    {
+      size_t j = constant_cols_list[k];
+      for (size_t i = 0; i < n; i++)
+        if (jacobian(i, j) != constant_jacobian(i, j))
+          return false;
+    }
+  return true;
+}
+
+bool
+DecisionRules::constantColumnsUnchanged(const CSCMatrix &jacobian) const
+{
+  const double *values = jacobian.getValues();
+  for (size_t k = 0; k < constant_cols_list.size(); k++)
+    {
+      size_t j = constant_cols_list[k], l = jacobian.colBegin(j);
+      for (size_t i = 0; i < n; i++)
+        {
+          double v = 0.0;
+          if (l < jacobian.colEnd(j) && jacobian.rowIndex(l) == i)
+            v = values[l++];
+          if (v != constant_jacobian(i, j))
+            return false;
+        }
+    }
+  return true;
+}
+
+void
+DecisionRules::compute(const Matrix &jacobian, Matrix &g_y, Matrix &g_u) throw (BlanchardKahnException, GeneralizedSchurDecomposition::GSDException)
+{
+  computeImpl(jacobian, g_y, g_u);
+}
+
+void
+DecisionRules::compute(const CSCMatrix &jacobian, Matrix &g_y, Matrix &g_u) throw (BlanchardKahnException, GeneralizedSchurDecomposition::GSDException)
+{
+  computeImpl(jacobian, g_y, g_u);
+}
+
+template<class Jac>
+void
+DecisionRules::fillPencil(const Jac &src)
+{
+  // Construct matrices D and E, starting from their parameter-independent parts
+  D = D_const;
+  for (size_t k = 0; k < D_cols_src.size(); k++)
+    mat::col_copy(src, D_cols_src[k], n_static, n - n_static, D, D_cols_dest[k], 0);
+
+  E = E_const;
+  for (size_t k = 0; k < E_cols_src.size(); k++)
+    {
+      mat::col_copy(src, E_cols_src[k], n_static, n - n_static, E, E_cols_dest[k], 0);
+      VectorView c(E.getData() + E_cols_dest[k]*E.getLd(), n - n_static, 1);
+      vec::negate(c);
+    }
+}
+
+void
+DecisionRules::multByJacobianBlock(const Matrix &jacobian, size_t col_offset, const Matrix &B, Matrix &C)
+{
+  blas::gemm("N", "N", 1.0, MatrixConstView(jacobian, 0, col_offset, n, B.getRows()), B, 0.0, C);
+}
+
+void
+DecisionRules::multByJacobianBlock(const CSCMatrix &jacobian, size_t col_offset, const Matrix &B, Matrix &C)
+{
+  mat::sparse_gemm(1.0, jacobian, col_offset, B, 0.0, C);
+}
+
+template<class Jac>
+void
+DecisionRules::computeImpl(const Jac &jacobian, Matrix &g_y, Matrix &g_u) throw (BlanchardKahnException, GeneralizedSchurDecomposition::GSDException)
+{
+  assert(jacobian.getRows() == n
+         && jacobian.getCols() == (n_back_mixed + n + n_fwrd_mixed + p));
+  assert(g_y.getRows() == n && g_y.getCols() == n_back_mixed);
+  assert(g_u.getRows() == n && g_u.getCols() == p);
+
+  // The caller's claim that some columns are constant is cheap to verify
+  if (!constant_cols_list.empty() && !constantColumnsUnchanged(jacobian))
+    initPencilMaps();
+
+  if (n_static > 0)
+    {
+      // Construct S, perform QR decomposition and get A = Q*jacobian
+      mat::cols_copy(jacobian, 0, A);
+      if (!static_QR_cached)
+        {
+          for (size_t i = 0; i < n_static; i++)
+            mat::col_copy(jacobian, n_back_mixed+zeta_static[i], S, i);
+          QR.compute(S);
+        }
+      QR.leftMultByQ(S, "T", A);
+      fillPencil(A);
+    }
+  else
+    // No static variable: the pencil is directly filled from the jacobian
+    fillPencil(jacobian);
 
   // Perform the generalized Schur
   size_t sdim;
@@ -181,9 +371,14 @@ DecisionRules::compute(const Matrix &jacobian, Matrix &g_y, Matrix &g_u) throw (
       blas::gemm("N", "N", 1.0, g_y_fwrd, g_y_back, 0.0, g_y_static_tmp);
       blas::gemm("N", "N", 1.0, MatrixView(A, 0, n_back_mixed + n, n_static, n_fwrd_mixed),
                  g_y_static_tmp, 1.0, g_y_static);
-      for (size_t i = 0; i < n_static; i++)
-        mat::col_copy(A, n_back_mixed + zeta_static[i], 0, n_static, A0s, i, 0);
-      LU3.invMult("N", A0s, g_y_static);
+      if (static_LU_cached)
+        LU3.solve("N", A0s, g_y_static);
+      else
+        {
+          for (size_t i = 0; i < n_static; i++)
+            mat::col_copy(A, n_back_mixed + zeta_static[i], 0, n_static, A0s, i, 0);
+          LU3.invMult("N", A0s, g_y_static);
+        }
       mat::negate(g_y_static);
 
       for (size_t i = 0; i < n_static; i++)
@@ -191,15 +386,15 @@ DecisionRules::compute(const Matrix &jacobian, Matrix &g_y, Matrix &g_u) throw (
     }
 
   // Compute DR for all endogenous w.r. to shocks
-  blas::gemm("N", "N", 1.0, MatrixConstView(jacobian, 0, n_back_mixed + n, n, n_fwrd_mixed), g_y_fwrd, 0.0, g_u_tmp1);
-  g_u_tmp2 = MatrixConstView(jacobian, 0, n_back_mixed, n, n);
+  multByJacobianBlock(jacobian, n_back_mixed + n, g_y_fwrd, g_u_tmp1);
+  mat::cols_copy(jacobian, n_back_mixed, g_u_tmp2);
   for (size_t i = 0; i < n_back_mixed; i++)
     {
       VectorView c1 = mat::get_col(g_u_tmp2, zeta_back_mixed[i]),
         c2 = mat::get_col(g_u_tmp1, i);
       vec::add(c1, c2);
     }
-  g_u = MatrixConstView(jacobian, 0, n_back_mixed + n + n_fwrd_mixed, n, p);
+  mat::cols_copy(jacobian, n_back_mixed + n + n_fwrd_mixed, g_u);
   LU4.invMult("N", g_u_tmp2, g_u);
   mat::negate(g_u);
 }
@@ -25,6 +25,7 @@
 #include "QRDecomposition.hh"
 #include "GeneralizedSchurDecomposition.hh"
 #include "LUSolver.hh"
+#include "SparseMatrix.hh"
 
 class DecisionRules
 {
@@ -35,6 +36,8 @@ private:
   std::vector<size_t> zeta_fwrd_mixed, zeta_back_mixed, zeta_dynamic,
     beta_back, beta_fwrd, pi_back, pi_fwrd;
   Matrix S, A, D, E, Z_prime;
+  //! Shared by the decompositions below; must be declared before them
+  LapackWorkspace workspace;
   QRDecomposition QR;
   GeneralizedSchurDecomposition GSD;
   LUSolver LU1, LU2, LU3;
@@ -42,6 +45,20 @@ private:
   Matrix g_y_static, A0s, A0d, g_y_dynamic, g_y_static_tmp;
   Matrix g_u_tmp1, g_u_tmp2;
   LUSolver LU4;
+  //! Columns of D and E filled from A = Q'*jacobian at every call (source column in A, destination column)
+  std::vector<size_t> D_cols_src, D_cols_dest, E_cols_src, E_cols_dest;
+  //! Parameter-independent parts of D and E (including the unit entries for mixed variables)
+  Matrix D_const, E_const;
+  //! Whether the QR decomposition of S (and the LU factorization of A0s) do not need to be recomputed
+  bool static_QR_cached, static_LU_cached;
+  //! Columns declared parameter-independent by setConstantColumns() (empty if nothing is cached), and their values
+  std::vector<size_t> constant_cols_list;
+  Matrix constant_jacobian;
+  //! Builds the column maps and the constant parts of D and E, assuming that all jacobian columns vary
+  void initPencilMaps();
+  //! Whether the constant columns of the jacobian still have the values given to setConstantColumns()
+  bool constantColumnsUnchanged(const Matrix &jacobian) const;
+  bool constantColumnsUnchanged(const CSCMatrix &jacobian) const;
 public:
   class BlanchardKahnException
   {
@@ -67,8 +84,31 @@ public:
     \param jacobian First columns are backetermined vars at t-1 (in the order of zeta_back_mixed), then all vars at t (in the orig order), then forward vars at t+1 (in the order of zeta_fwrd_mixed), then exogenous vars.
   */
   void compute(const Matrix &jacobian, Matrix &g_y, Matrix &g_u) throw (BlanchardKahnException, GeneralizedSchurDecomposition::GSDException);
+  //! Same as above, with a jacobian in sparse (CSC) format
+  void compute(const CSCMatrix &jacobian, Matrix &g_y, Matrix &g_u) throw (BlanchardKahnException, GeneralizedSchurDecomposition::GSDException);
+  /*!
+    Declares which jacobian columns do not depend on the parameters, and
+    caches what can be derived from them: the QR decomposition of the static
+    columns, the LU factorization of the static block, and the corresponding
+    parts of the D and E matrices. Subsequent calls to compute() only recompute
+    the parameter-dependent parts. Each call to compute() first checks that
+    the constant columns have not changed, and drops the cached blocks if
+    they have.
+    \param jacobian A jacobian, in the same format as for compute()
+    \param constant_cols For every column of the jacobian, true if it is parameter-independent
+  */
+  void setConstantColumns(const Matrix &jacobian, const std::vector<bool> &constant_cols);
   template<class Vec1, class Vec2>
   void getGeneralizedEigenvalues(Vec1 &eig_real, Vec2 &eig_cmplx);
+private:
+  //! Fills D and E from the rows of src below the static block (src is either A, or the jacobian if there is no static variable)
+  template<class Jac>
+  void fillPencil(const Jac &src);
+  //! Computes C = jacobian(:, col_offset:col_offset+B.getRows()-1)*B
+  void multByJacobianBlock(const Matrix &jacobian, size_t col_offset, const Matrix &B, Matrix &C);
+  void multByJacobianBlock(const CSCMatrix &jacobian, size_t col_offset, const Matrix &B, Matrix &C);
+  template<class Jac>
+  void computeImpl(const Jac &jacobian, Matrix &g_y, Matrix &g_u) throw (BlanchardKahnException, GeneralizedSchurDecomposition::GSDException);
 };
 
 std::ostream &operator<<(std::ostream &out, const DecisionRules::BlanchardKahnException &e);
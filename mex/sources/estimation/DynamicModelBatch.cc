@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+///////////////////////////////////////////////////////////
+//  DynamicModelBatch.cc
+//  Implementation of the Class DynamicModelBatch
+///////////////////////////////////////////////////////////
+
+#include "DynamicModelBatch.hh"
+
+DynamicModelBatch::DynamicModelBatch(const std::string &basename, size_t nWorkers) throw (TSException) :
+  dynamicDLL(basename), pool(nWorkers)
+{
+}
+
+void
+DynamicModelBatch::eval(const Matrix &Y, const Matrix &X, const Vector &modParams, const Vector &ySteady,
+                        Matrix &residuals, Matrix *g1) throw (TSException)
+{
+  size_t nPoints = Y.getCols();
+  assert(X.getRows() == nPoints && residuals.getCols() == nPoints);
+  assert(g1 == NULL || g1->getCols() == nPoints*(Y.getRows() + X.getCols()));
+  if (nPoints == 0)
+    return;
+
+  size_t chunkSize = (nPoints + pool.getNumWorkers()*chunksPerWorker - 1) / (pool.getNumWorkers()*chunksPerWorker);
+  if (chunkSize < minChunkSize)
+    chunkSize = minChunkSize;
+
+  EvalTask task(dynamicDLL, Y, X, modParams, ySteady, residuals, g1, chunkSize);
+  pool.run(task, (nPoints + chunkSize - 1) / chunkSize);
+}
+
+void
+DynamicModelBatch::EvalTask::run(size_t item, size_t worker)
+{
+  size_t first = item*chunkSize;
+  size_t last = first + chunkSize < nPoints ? first + chunkSize : nPoints;
+  dynamicDLL.evalPoints(Y, X, modParams, ySteady, residuals, g1, first, last);
+}
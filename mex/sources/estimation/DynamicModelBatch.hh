@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+///////////////////////////////////////////////////////////
+//  DynamicModelBatch.hh
+//  Implementation of the Class DynamicModelBatch
+///////////////////////////////////////////////////////////
+
+#if !defined(DMB_8A2F4C17_5B3E_4D96_A1C0_7E9D3B6F2C58__INCLUDED_)
+#define DMB_8A2F4C17_5B3E_4D96_A1C0_7E9D3B6F2C58__INCLUDED_
+
+#include "dynamic_dll.hh"
+#include "thread_pool.hh"
+
+/**
+ * Evaluates the residuals (and optionally the jacobian) of the dynamic model
+ * at many points, splitting the points across a pool of threads.
+ *
+ * This is for computations which evaluate the model along whole paths
+ * rather than at the steady state, e.g. the residuals of simulated or
+ * smoothed paths, or the linearizations along them; it is not used by the
+ * estimation routines, which only need the jacobian at the steady state.
+ *
+ * Points are handed out in contiguous chunks, and each point is written to
+ * its own columns of the outputs, so the results do not depend on the number
+ * of threads.
+ */
+class DynamicModelBatch
+{
+public:
+  /**
+   * \param nWorkers Number of threads (a value of 1 means a serial computation)
+   */
+  DynamicModelBatch(const std::string &basename, size_t nWorkers) throw (TSException);
+  virtual ~DynamicModelBatch()
+  {
+  };
+
+  size_t
+  getNumWorkers() const
+  {
+    return pool.getNumWorkers();
+  };
+
+  /**
+   * Evaluates the model at every point, see DynamicModelDLL::evalPoints() for the layout of the arguments.
+   * \param[out] g1 Jacobians, can be NULL
+   */
+  void eval(const Matrix &Y, const Matrix &X, const Vector &modParams, const Vector &ySteady,
+            Matrix &residuals, Matrix *g1) throw (TSException);
+
+private:
+  class EvalTask : public ThreadPool::Task
+  {
+  public:
+    DynamicModelDLL &dynamicDLL;
+    const Matrix &Y, &X;
+    const Vector &modParams, &ySteady;
+    Matrix &residuals;
+    Matrix *g1;
+    size_t nPoints, chunkSize;
+    EvalTask(DynamicModelDLL &dynamicDLL_arg, const Matrix &Y_arg, const Matrix &X_arg, const Vector &modParams_arg,
+             const Vector &ySteady_arg, Matrix &residuals_arg, Matrix *g1_arg, size_t chunkSize_arg) :
+      dynamicDLL(dynamicDLL_arg), Y(Y_arg), X(X_arg), modParams(modParams_arg), ySteady(ySteady_arg),
+      residuals(residuals_arg), g1(g1_arg), nPoints(Y_arg.getCols()), chunkSize(chunkSize_arg)
+    {
+    };
+    virtual void run(size_t item, size_t worker);
+  };
+
+  //! Minimal number of points per chunk, so that small batches are not split too finely
+  static const size_t minChunkSize = 16;
+  //! Number of chunks per worker, for load balancing
+  static const size_t chunksPerWorker = 4;
+
+  DynamicModelDLL dynamicDLL;
+  ThreadPool pool;
+};
+
+#endif // !defined(DMB_8A2F4C17_5B3E_4D96_A1C0_7E9D3B6F2C58__INCLUDED_)
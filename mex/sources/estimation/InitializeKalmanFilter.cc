@@ -47,7 +47,9 @@ InitializeKalmanFilter::InitializeKalmanFilter(const std::string &basename, size
   g_x(n_endo_arg, zeta_back_arg.size() + zeta_mixed_arg.size()),
   g_u(n_endo_arg, n_exo_arg),
   Rt(n_exo_arg, zeta_varobs_back_mixed.size()),
-  RQ(zeta_varobs_back_mixed.size(), n_exo_arg)
+  RQ(zeta_varobs_back_mixed.size(), n_exo_arg),
+  cachedSteadyState(n_endo_arg),
+  solutionCached(false)
 {
   std::vector<size_t> zeta_back_mixed;
   set_union(zeta_back_arg.begin(), zeta_back_arg.end(),
@@ -51,6 +51,11 @@ public:
                          bool noconstant_arg);
   virtual
   ~InitializeKalmanFilter();
+  void
+  setModelSolutionOptions(const ModelSolution::Options &options)
+  {
+    modelSolution.setOptions(options);
+  };
   // initialise parameter dependent KF matrices only but not Ps
   template <class Vec1, class Vec2, class Mat1, class Mat2>
   void
@@ -59,7 +64,19 @@ public:
              const MatrixConstView &dataView,
              MatrixView &detrendedDataView)
   {
-    modelSolution.compute(steadyState, deepParams, g_x, g_u);
+    // The model solution only depends on deep parameters: reuse it if they did not change
+    if (solutionCached && sameDeepParams(deepParams))
+      steadyState = cachedSteadyState;
+    else
+      {
+        solutionCached = false;
+        modelSolution.compute(steadyState, deepParams, g_x, g_u);
+        cachedDeepParams.resize(deepParams.getSize());
+        for (size_t i = 0; i < deepParams.getSize(); i++)
+          cachedDeepParams[i] = deepParams(i);
+        cachedSteadyState = steadyState;
+        solutionCached = true;
+      }
     detrendData.detrend(steadyState, dataView, detrendedDataView);
 
     setT(T);
@@ -90,8 +107,24 @@ private:
   Matrix g_x;
   Matrix g_u;
   Matrix Rt, RQ;
+  //! Deep parameters and steady state corresponding to g_x and g_u, valid if solutionCached is true
+  std::vector<double> cachedDeepParams;
+  Vector cachedSteadyState;
+  bool solutionCached;
   void setT(Matrix &T);
 
+  template <class Vec>
+  bool
+  sameDeepParams(const Vec &deepParams) const
+  {
+    if (deepParams.getSize() != cachedDeepParams.size())
+      return false;
+    for (size_t i = 0; i < cachedDeepParams.size(); i++)
+      if (deepParams(i) != cachedDeepParams[i])
+        return false;
+    return true;
+  }
+
   template <class Mat1, class Mat2>
   void
   setRQR(Mat1 &R, const Mat2 &Q, Matrix &RQRt)
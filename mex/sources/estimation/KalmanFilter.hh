@@ -56,11 +56,27 @@ public:
                double riccati_tol_arg, double lyapunov_tol_arg,
                bool noconstant_arg);
 
+  void
+  setModelSolutionOptions(const ModelSolution::Options &options)
+  {
+    initKalmanFilter.setModelSolutionOptions(options);
+  };
+
   template <class Vec1, class Vec2, class Mat1>
   double
   compute(const MatrixConstView &dataView, Vec1 &steadyState,
           const Mat1 &Q, const Matrix &H, const Vec2 &deepParams,
           VectorView &vll, MatrixView &detrendedDataView, size_t start, size_t period)
+  {
+    initialize(dataView, steadyState, Q, deepParams, detrendedDataView, period);
+    return filter(detrendedDataView, H, vll, start);
+  }
+
+  //! First stage of compute(): solves the model and sets the KF matrices of a period
+  template <class Vec1, class Vec2, class Mat1>
+  void
+  initialize(const MatrixConstView &dataView, Vec1 &steadyState, const Mat1 &Q, const Vec2 &deepParams,
+             MatrixView &detrendedDataView, size_t period)
   {
     if (period == 0) // initialise all KF matrices
       initKalmanFilter.initialize(steadyState, deepParams, R, Q, RQRt, T, Pstar, Pinf,
@@ -68,10 +84,18 @@ public:
     else                           // initialise parameter dependent KF matrices only but not Ps
       initKalmanFilter.initialize(steadyState, deepParams, R, Q, RQRt, T,
                                   dataView, detrendedDataView);
+  }
 
-    return filter(detrendedDataView, H, vll, start);
+  //! Continues from the state covariance reached at the end of the period filtered by previous
+  void
+  continueFrom(const KalmanFilter &previous)
+  {
+    Pstar = previous.Pstar;
   }
 
+  //! Second stage of compute()
+  double filter(const MatrixView &detrendedDataView,  const Matrix &H, VectorView &vll, size_t start);
+
 private:
   const std::vector<size_t> zeta_varobs_back_mixed;
   static std::vector<size_t> compute_zeta_varobs_back_mixed(const std::vector<size_t> &zeta_back_arg, const std::vector<size_t> &zeta_mixed_arg, const std::vector<size_t> &varobs_arg);
@@ -91,9 +115,6 @@ private:
   InitializeKalmanFilter initKalmanFilter; //Initialise KF matrices
   Vector FUTP; // F upper triangle packed as vector FUTP(i + (j-1)*j/2) = F(i,j) for 1<=i<=j;
 
-  // Method
-  double filter(const MatrixView &detrendedDataView,  const Matrix &H, VectorView &vll, size_t start);
-
 };
 
 #endif // !defined(213B0417_532B_4027_9EDF_36C004CB4CD1__INCLUDED_)
@@ -29,18 +29,37 @@ LogLikelihoodMain::LogLikelihoodMain(const std::string &basename, EstimatedParam
                                      const std::vector<size_t> &zeta_fwrd_arg, const std::vector<size_t> &zeta_back_arg,
                                      const std::vector<size_t> &zeta_mixed_arg, const std::vector<size_t> &zeta_static_arg, const double qz_criterium,
                                      const std::vector<size_t> &varobs, double riccati_tol, double lyapunov_tol,
-                                     bool noconstant_arg)
+                                     bool noconstant_arg, size_t nThreads)
 
 : estSubsamples(estiParDesc.estSubsamples),
-  logLikelihoodSubSample(basename, estiParDesc, n_endo, n_exo, zeta_fwrd_arg, zeta_back_arg, zeta_mixed_arg, zeta_static_arg, qz_criterium,
-                         varobs, riccati_tol, lyapunov_tol, noconstant_arg),
   vll(estiParDesc.getNumberOfPeriods()), // time dimension size of data
-  detrendedData(varobs.size(), estiParDesc.getNumberOfPeriods())
+  detrendedData(varobs.size(), estiParDesc.getNumberOfPeriods()),
+  pool(estSubsamples.size() > 1 ? std::min(nThreads, estSubsamples.size()) : 1)
 {
-
+  try
+    {
+      for (size_t i = 0; i < estSubsamples.size(); ++i)
+        logLikelihoodSubSamples.push_back(new LogLikelihoodSubSample(basename, estiParDesc, n_endo, n_exo, zeta_fwrd_arg, zeta_back_arg,
+                                                                     zeta_mixed_arg, zeta_static_arg, qz_criterium,
+                                                                     varobs, riccati_tol, lyapunov_tol, noconstant_arg));
+      if (estSubsamples.size() > 1)
+        for (size_t i = 0; i < estSubsamples.size(); ++i)
+          states.push_back(new SubSampleState(n_endo, n_exo, varobs.size()));
+    }
+  catch (...)
+    {
+      for (size_t i = 0; i < logLikelihoodSubSamples.size(); ++i)
+        delete logLikelihoodSubSamples[i];
+      for (size_t i = 0; i < states.size(); ++i)
+        delete states[i];
+      throw;
+    }
 }
 
 LogLikelihoodMain::~LogLikelihoodMain()
 {
-
+  for (size_t i = 0; i < logLikelihoodSubSamples.size(); ++i)
+    delete logLikelihoodSubSamples[i];
+  for (size_t i = 0; i < states.size(); ++i)
+    delete states[i];
 }
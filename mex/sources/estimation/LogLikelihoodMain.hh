@@ -26,15 +26,124 @@
 #define E126AEF5_AC28_400a_821A_3BCFD1BC4C22__INCLUDED_
 
 #include "LogLikelihoodSubSample.hh"
+#include "thread_pool.hh"
 
 class LogLikelihoodMain
 {
 private:
   std::vector<EstimationSubsample> &estSubsamples; // reference to member of EstimatedParametersDescription
-  LogLikelihoodSubSample logLikelihoodSubSample;
+  //! One per subsample, so that each one has its own filter state
+  std::vector<LogLikelihoodSubSample *> logLikelihoodSubSamples;
   Vector vll;  // vector of all KF step likelihoods
   Matrix detrendedData;
 
+  //! Private copies of the inputs modified by each subsample, when several subsamples are evaluated concurrently
+  struct SubSampleState
+  {
+    Vector steadyState;
+    std::vector<double> deepParams;
+    Matrix Q, H;
+    bool failed;
+    SubSampleState(size_t n_endo, size_t n_exo, size_t n_obs) :
+      steadyState(n_endo), Q(n_exo), H(n_obs), failed(false)
+    {
+    };
+  };
+  std::vector<SubSampleState *> states;
+  ThreadPool pool;
+
+  //! Prepares a subsample on its private copy of the inputs
+  template <class VEC1, class VEC2>
+  class SubSampleTask : public ThreadPool::Task
+  {
+  public:
+    LogLikelihoodMain &main;
+    VEC1 &steadyState;
+    VEC2 &estParams;
+    VectorView &deepParams;
+    const MatrixConstView &data;
+    MatrixView &Q;
+    Matrix &H;
+    SubSampleTask(LogLikelihoodMain &main_arg, VEC1 &steadyState_arg, VEC2 &estParams_arg, VectorView &deepParams_arg,
+                  const MatrixConstView &data_arg, MatrixView &Q_arg, Matrix &H_arg) :
+      main(main_arg), steadyState(steadyState_arg), estParams(estParams_arg), deepParams(deepParams_arg),
+      data(data_arg), Q(Q_arg), H(H_arg)
+    {
+    };
+    virtual void
+    run(size_t item, size_t worker)
+    {
+      SubSampleState &state = *main.states[item];
+      state.failed = false;
+      try
+        {
+          main.prepareSubSample(state, steadyState, estParams, deepParams, data, Q, H, item);
+        }
+      catch (...)
+        {
+          // The exception is raised again by the calling thread
+          state.failed = true;
+        }
+    };
+  };
+
+  /*!
+    Prepares subsample i on the private copies in state, initialized from the inputs.
+    Subsample i sees the parameters of all the subsamples up to i, as in a sequential evaluation,
+    but its steady state computation starts from the input steadyState.
+  */
+  template <class VEC1, class VEC2>
+  void
+  prepareSubSample(SubSampleState &state, const VEC1 &steadyState, VEC2 &estParams, const VectorView &deepParams,
+                   const MatrixConstView &data, const MatrixView &Q, const Matrix &H, size_t i)
+  {
+    state.steadyState = steadyState;
+    state.deepParams.resize(deepParams.getSize());
+    VectorView stateDeepParams(&state.deepParams[0], state.deepParams.size(), 1);
+    stateDeepParams = deepParams;
+    state.Q = Q;
+    state.H = H;
+    MatrixView stateQ(state.Q, 0, 0, state.Q.getRows(), state.Q.getCols());
+    VectorView stateSteadyState(state.steadyState, 0, state.steadyState.getSize());
+
+    for (size_t j = 0; j < i; ++j)
+      logLikelihoodSubSamples[i]->applyParams(estParams, stateDeepParams, stateQ, state.H, j);
+
+    MatrixConstView dataView(data, 0, estSubsamples[i].startPeriod, data.getRows(), subSampleLength(i));
+    MatrixView detrendedDataView(detrendedData, 0, estSubsamples[i].startPeriod, data.getRows(), subSampleLength(i));
+    logLikelihoodSubSamples[i]->prepare(stateSteadyState, dataView, estParams, stateDeepParams,
+                                        stateQ, state.H, detrendedDataView, i);
+  };
+
+  //! Filters prepared subsample i, continuing from the end of subsample i-1
+  double
+  filterSubSample(size_t i, const Matrix &H, size_t start)
+  {
+    MatrixView detrendedDataView(detrendedData, 0, estSubsamples[i].startPeriod, detrendedData.getRows(), subSampleLength(i));
+    VectorView vllView(vll, estSubsamples[i].startPeriod, subSampleLength(i));
+    return logLikelihoodSubSamples[i]->filter(i > 0 ? logLikelihoodSubSamples[i-1] : NULL,
+                                              detrendedDataView, H, vllView, start);
+  };
+
+  size_t
+  subSampleLength(size_t i) const
+  {
+    return estSubsamples[i].endPeriod-estSubsamples[i].startPeriod+1;
+  };
+
+  template <class VEC1, class VEC2>
+  double
+  computeSubSample(VEC1 &steadyState, VEC2 &estParams, VectorView &deepParams, const MatrixConstView &data,
+                   MatrixView &Q, Matrix &H, size_t start, size_t i)
+  {
+    MatrixConstView dataView(data, 0, estSubsamples[i].startPeriod, data.getRows(), subSampleLength(i));
+    MatrixView detrendedDataView(detrendedData, 0, estSubsamples[i].startPeriod, data.getRows(), subSampleLength(i));
+
+    VectorView vllView(vll, estSubsamples[i].startPeriod, subSampleLength(i));
+    return logLikelihoodSubSamples[i]->compute(steadyState, dataView, estParams, deepParams,
+                                               Q, H, vllView, detrendedDataView, start, i);
+  };
+
 public:
   virtual
   ~LogLikelihoodMain();
@@ -42,7 +151,7 @@ public:
                     const std::vector<size_t> &zeta_fwrd_arg, const std::vector<size_t> &zeta_back_arg, const std::vector<size_t> &zeta_mixed_arg,
                     const std::vector<size_t> &zeta_static_arg, const double qz_criterium_arg, const std::vector<size_t> &varobs_arg,
                     double riccati_tol_arg, double lyapunov_tol_arg,
-                    bool noconstant_arg);
+                    bool noconstant_arg, size_t nThreads = ThreadPool::defaultNumWorkers());
 
   /**
    * Compute method Inputs:
@@ -51,6 +160,13 @@ public:
    * Matrix &data input data reference
    * Q and H KF matrices of shock and measurement error varinaces and covariances
    * KF logLikelihood calculation start period.
+   *
+   * With several subsamples, the parameter updates and model solutions of all the subsamples run concurrently,
+   * each one on private copies of steadyState, deepParams, Q and H. The steady state computation of every
+   * subsample therefore starts from the input steadyState, and not from the steady state of the previous
+   * subsample. The filter passes then run in order, each subsample starting from the state covariance
+   * reached at the end of the previous one. On return, steadyState, deepParams, Q and H are those of the
+   * last subsample.
    */
 
   template <class VEC1, class VEC2>
@@ -58,21 +174,41 @@ public:
   compute(VEC1 &steadyState, VEC2 &estParams, VectorView &deepParams, const MatrixConstView &data,
           MatrixView &Q, Matrix &H, size_t start)
   {
+    size_t n = estSubsamples.size();
+    if (n == 1)
+      return computeSubSample(steadyState, estParams, deepParams, data, Q, H, start, 0);
+
+    // Subsamples are prepared concurrently, each on its own copy of the inputs
+    SubSampleTask<VEC1, VEC2> task(*this, steadyState, estParams, deepParams, data, Q, H);
+    pool.run(task, n);
+
+    // A failed subsample is prepared again in the calling thread, to propagate its exception
+    for (size_t i = 0; i < n; ++i)
+      if (states[i]->failed)
+        prepareSubSample(*states[i], steadyState, estParams, deepParams, data, Q, H, i);
+
+    // The filter carries its state covariance from one subsample to the next
     double logLikelihood = 0;
-    for (size_t i = 0; i < estSubsamples.size(); ++i)
-      {
-        MatrixConstView dataView(data, 0, estSubsamples[i].startPeriod,
-                                 data.getRows(), estSubsamples[i].endPeriod-estSubsamples[i].startPeriod+1);
-        MatrixView detrendedDataView(detrendedData, 0, estSubsamples[i].startPeriod,
-                                     data.getRows(), estSubsamples[i].endPeriod-estSubsamples[i].startPeriod+1);
-
-        VectorView vllView(vll, estSubsamples[i].startPeriod, estSubsamples[i].endPeriod-estSubsamples[i].startPeriod+1);
-        logLikelihood += logLikelihoodSubSample.compute(steadyState, dataView, estParams, deepParams,
-                                                        Q, H, vllView, detrendedDataView, start, i);
-      }
+    for (size_t i = 0; i < n; ++i)
+      logLikelihood += filterSubSample(i, states[i]->H, start);
+
+    // The outputs are those of a sequential evaluation, i.e. after the last subsample
+    SubSampleState &last = *states[n-1];
+    steadyState = last.steadyState;
+    deepParams = VectorConstView(&last.deepParams[0], last.deepParams.size(), 1);
+    Q = last.Q;
+    H = last.H;
     return logLikelihood;
   };
 
+  //! Applies to the model solutions of all the subsamples
+  void
+  setModelSolutionOptions(const ModelSolution::Options &options)
+  {
+    for (size_t i = 0; i < logLikelihoodSubSamples.size(); ++i)
+      logLikelihoodSubSamples[i]->setModelSolutionOptions(options);
+  };
+
   Vector &
   getVll()
   {
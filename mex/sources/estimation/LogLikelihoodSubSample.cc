@@ -35,6 +35,46 @@ LogLikelihoodSubSample::LogLikelihoodSubSample(const std::string &basename, Esti
                                                const std::vector<size_t> &varobs, double riccati_tol, double lyapunov_tol, bool noconstant_arg) :
   estiParDesc(INestiParDesc),
   kalmanFilter(basename, n_endo, n_exo, zeta_fwrd_arg, zeta_back_arg, zeta_mixed_arg, zeta_static_arg, qz_criterium,
-               varobs, riccati_tol, lyapunov_tol, noconstant_arg), eigQ(n_exo), eigH(varobs.size())
+               varobs, riccati_tol, lyapunov_tol, noconstant_arg), eigQ(n_exo, eigWorkspace), eigH(varobs.size(), eigWorkspace),
+  QScratch(n_exo), HScratch(varobs.size())
 {
+  eigWorkspace.allocate();
+  compilePlans();
 };
+
+void
+LogLikelihoodSubSample::compilePlans()
+{
+  plans.assign(estiParDesc.estSubsamples.size(), UpdatePlan());
+  for (size_t i = 0; i < estiParDesc.estParams.size(); ++i)
+    {
+      const EstimatedParameter &par = estiParDesc.estParams[i];
+      UpdatePlan::Entry e = { i, par.ID1, par.ID2 };
+      for (size_t j = 0; j < par.subSampleIDs.size(); ++j)
+        {
+          size_t period = par.subSampleIDs[j];
+          if (period >= plans.size())
+            continue; // Never used
+          switch (par.ptype)
+            {
+            case EstimatedParameter::shock_SD:
+              plans[period].shockSD.push_back(e);
+              break;
+            case EstimatedParameter::measureErr_SD:
+              plans[period].measureErrSD.push_back(e);
+              break;
+            case EstimatedParameter::shock_Corr:
+              plans[period].shockCorr.push_back(e);
+              break;
+            case EstimatedParameter::measureErr_Corr:
+              plans[period].measureErrCorr.push_back(e);
+              break;
+            case EstimatedParameter::deepPar:
+              plans[period].deepPar.push_back(e);
+              break;
+            default:
+              assert(false);
+            }
+        }
+    }
+}
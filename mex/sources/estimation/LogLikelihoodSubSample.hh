@@ -51,9 +51,50 @@ public:
     return kalmanFilter.compute(dataView, steadyState,  Q, H, deepParams, vll, detrendedDataView, start, period);
   }
 
+  /*!
+    First stage of compute(): applies the parameters of the subsample and solves the model.
+    Subsamples can be prepared concurrently, since they do not depend on each other's filter.
+  */
+  template <class VEC1, class VEC2>
+  void
+  prepare(VEC1 &steadyState, const MatrixConstView &dataView, VEC2 &estParams, VectorView &deepParams,
+          MatrixView &Q, Matrix &H, MatrixView &detrendedDataView, size_t period)
+  {
+    updateParams(estParams, deepParams, Q, H, period);
+    kalmanFilter.initialize(dataView, steadyState, Q, deepParams, detrendedDataView, period);
+  }
+
+  /*!
+    Second stage of compute(): runs the filter of a prepared subsample.
+    Unless previous is NULL, it starts from the state covariance reached at the end of the previous subsample,
+    which must therefore have been filtered before.
+  */
+  double
+  filter(const LogLikelihoodSubSample *previous, const MatrixView &detrendedDataView, const Matrix &H,
+         VectorView &vll, size_t start)
+  {
+    if (previous)
+      kalmanFilter.continueFrom(previous->kalmanFilter);
+    return kalmanFilter.filter(detrendedDataView, H, vll, start);
+  }
+
+  //! Only applies the parameters of a subsample to deepParams, Q and H
+  template <class VEC>
+  void
+  applyParams(VEC &estParams, VectorView &deepParams, MatrixView &Q, Matrix &H, size_t period)
+  {
+    updateParams(estParams, deepParams, Q, H, period);
+  }
+
   virtual
   ~LogLikelihoodSubSample();
 
+  void
+  setModelSolutionOptions(const ModelSolution::Options &options)
+  {
+    kalmanFilter.setModelSolutionOptions(options);
+  };
+
   class UpdateParamsException
   {
   public:
@@ -66,110 +107,90 @@ public:
 private:
   EstimatedParametersDescription &estiParDesc;
   KalmanFilter kalmanFilter;
+  //! Shared by eigQ and eigH, which are never used concurrently
+  LapackWorkspace eigWorkspace;
   VDVEigDecomposition eigQ;
   VDVEigDecomposition eigH;
 
+  //! Parameters which apply to a subsample, with their target indices, grouped by type
+  struct UpdatePlan
+  {
+    struct Entry
+    {
+      size_t param, ID1, ID2;
+    };
+    std::vector<Entry> shockSD, measureErrSD, shockCorr, measureErrCorr, deepPar;
+  };
+  //! One plan per subsample, compiled at construction
+  std::vector<UpdatePlan> plans;
+  //! Scratch copies of Q and H, for the positive-definiteness tests
+  Matrix QScratch, HScratch;
+
   // methods
+  void compilePlans();
+
+  //! Throws an UpdateParamsException if the covariance matrix M is not positive definite
+  template <class MAT>
+  void
+  checkPositiveDefinite(const MAT &M, Matrix &scratch, VDVEigDecomposition &eig)
+  {
+    //   [CholQ,testQ] = chol(Q);
+    scratch = M;
+    int test = lapack::choleskyDecomp(scratch, "L");
+    assert(test >= 0);
+
+    if (test > 0)
+      {
+        // The variance-covariance matrix is not definite positive.
+        // We have to compute the eigenvalues of this matrix in order to build the penalty.
+        double delta = 0;
+        eig.calculate(M);  // get eigenvalues
+        //k = find(a < 0);
+        if (eig.hasConverged())
+          {
+            const Vector &ev = eig.getD();
+            for (size_t i = 0; i < ev.getSize(); ++i)
+              if (ev(i) < 0)
+                delta -= ev(i);
+          }
+        throw UpdateParamsException(delta);
+      }
+  };
+
   template <class VEC>
   void
   updateParams(VEC &estParams, VectorView &deepParams,
                MatrixView &Q, Matrix &H, size_t period)
   {
-    size_t i, k, k1, k2;
-    int test;
-    bool found;
-    std::vector<size_t>::const_iterator it;
+    assert(period < plans.size());
+    const UpdatePlan &plan = plans[period];
+    std::vector<UpdatePlan::Entry>::const_iterator it;
+
+    // Variances first, since the covariances depend on them
+    for (it = plan.shockSD.begin(); it != plan.shockSD.end(); ++it)
+      Q(it->ID1, it->ID1) = estParams(it->param)*estParams(it->param);
+    for (it = plan.measureErrSD.begin(); it != plan.measureErrSD.end(); ++it)
+      H(it->ID1, it->ID1) = estParams(it->param)*estParams(it->param);
 
-    for (i = 0; i <  estParams.getSize(); ++i)
+    for (it = plan.shockCorr.begin(); it != plan.shockCorr.end(); ++it)
       {
-        found = false;
-        it = find(estiParDesc.estParams[i].subSampleIDs.begin(),
-                  estiParDesc.estParams[i].subSampleIDs.end(), period);
-        if (it != estiParDesc.estParams[i].subSampleIDs.end())
-          found = true;
-        if (found)
-          {
-            switch (estiParDesc.estParams[i].ptype)
-              {
-              case EstimatedParameter::shock_SD:
-                k = estiParDesc.estParams[i].ID1;
-                Q(k, k) = estParams(i)*estParams(i);
-                break;
-
-              case EstimatedParameter::measureErr_SD:
-                k = estiParDesc.estParams[i].ID1;
-                H(k, k) = estParams(i)*estParams(i);
-                break;
-
-              case EstimatedParameter::shock_Corr:
-                k1 = estiParDesc.estParams[i].ID1;
-                k2 = estiParDesc.estParams[i].ID2;
-                Q(k1, k2) = estParams(i)*sqrt(Q(k1, k1)*Q(k2, k2));
-                Q(k2, k1) = Q(k1, k2);
-                //   [CholQ,testQ] = chol(Q);
-                test = lapack::choleskyDecomp(Q, "L");
-                assert(test >= 0);
-
-                if (test > 0)
-                  {
-                    // The variance-covariance matrix of the structural innovations is not definite positive.
-                    // We have to compute the eigenvalues of this matrix in order to build the penalty.
-                    double delta = 0;
-                    eigQ.calculate(Q);  // get eigenvalues
-                    //k = find(a < 0);
-                    if (eigQ.hasConverged())
-                      {
-                        const Vector &evQ = eigQ.getD();
-                        for (i = 0; i < evQ.getSize(); ++i)
-                          if (evQ(i) < 0)
-                            delta -= evQ(i);
-                      }
-
-                    throw UpdateParamsException(delta);
-                  } // if
-                break;
-
-              case EstimatedParameter::measureErr_Corr:
-                k1 = estiParDesc.estParams[i].ID1;
-                k2 = estiParDesc.estParams[i].ID2;
-                //      H(k1,k2) = xparam1(i)*sqrt(H(k1,k1)*H(k2,k2));
-                //      H(k2,k1) = H(k1,k2);
-                H(k1, k2) = estParams(i)*sqrt(H(k1, k1)*H(k2, k2));
-                H(k2, k1) = H(k1, k2);
-
-                //[CholH,testH] = chol(H);
-                test = lapack::choleskyDecomp(H, "L");
-                assert(test >= 0);
-
-                if (test > 0)
-                  {
-                    // The variance-covariance matrix of the measurement errors is not definite positive.
-                    // We have to compute the eigenvalues of this matrix in order to build the penalty.
-                    //a = diag(eig(H));
-                    double delta = 0;
-                    eigH.calculate(H);  // get eigenvalues
-                    //k = find(a < 0);
-                    if (eigH.hasConverged())
-                      {
-                        const Vector &evH = eigH.getD();
-                        for (i = 0; i < evH.getSize(); ++i)
-                          if (evH(i) < 0)
-                            delta -= evH(i);
-                      }
-                    throw UpdateParamsException(delta);
-                  } //   end if
-                break;
-
-                //if estim_params_.np > 0  // i.e. num of deep parameters >0
-              case EstimatedParameter::deepPar:
-                k = estiParDesc.estParams[i].ID1;
-                deepParams(k) = estParams(i);
-                break;
-              default:
-                assert(false);
-              } // end switch
-          } // end found
-      } //end for
+        Q(it->ID1, it->ID2) = estParams(it->param)*sqrt(Q(it->ID1, it->ID1)*Q(it->ID2, it->ID2));
+        Q(it->ID2, it->ID1) = Q(it->ID1, it->ID2);
+      }
+    for (it = plan.measureErrCorr.begin(); it != plan.measureErrCorr.end(); ++it)
+      {
+        H(it->ID1, it->ID2) = estParams(it->param)*sqrt(H(it->ID1, it->ID1)*H(it->ID2, it->ID2));
+        H(it->ID2, it->ID1) = H(it->ID1, it->ID2);
+      }
+
+    // Only correlations can make the matrices lose positive definiteness
+    if (!plan.shockCorr.empty())
+      checkPositiveDefinite(Q, QScratch, eigQ);
+    if (!plan.measureErrCorr.empty())
+      checkPositiveDefinite(H, HScratch, eigH);
+
+    for (it = plan.deepPar.begin(); it != plan.deepPar.end(); ++it)
+      deepParams(it->ID1) = estParams(it->param);
   };
 
 };
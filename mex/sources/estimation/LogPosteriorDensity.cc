@@ -23,6 +23,8 @@
 //  Created on:      10-Feb-2010 20:54:18
 ///////////////////////////////////////////////////////////
 
+#include <sys/time.h>
+
 #include "LogPosteriorDensity.hh"
 
 LogPosteriorDensity::~LogPosteriorDensity()
@@ -33,12 +35,29 @@ LogPosteriorDensity::LogPosteriorDensity(const std::string &modName, EstimatedPa
                                          const std::vector<size_t> &zeta_fwrd_arg, const std::vector<size_t> &zeta_back_arg, const std::vector<size_t> &zeta_mixed_arg,
                                          const std::vector<size_t> &zeta_static_arg, const double qz_criterium_arg, const std::vector<size_t> &varobs_arg,
                                          double riccati_tol_arg, double lyapunov_tol_arg,
-                                         bool noconstant_arg) :
+                                         bool noconstant_arg, size_t nThreads) :
   logPriorDensity(estParamsDesc),
   logLikelihoodMain(modName, estParamsDesc, n_endo, n_exo, zeta_fwrd_arg, zeta_back_arg, zeta_mixed_arg,
-                    zeta_static_arg, qz_criterium_arg, varobs_arg, riccati_tol_arg, lyapunov_tol_arg, noconstant_arg)
+                    zeta_static_arg, qz_criterium_arg, varobs_arg, riccati_tol_arg, lyapunov_tol_arg, noconstant_arg, nThreads)
+{
+  resetCounters();
+}
+
+void
+LogPosteriorDensity::resetCounters()
 {
+  counters.evaluations = 0;
+  counters.priorShortCircuits = 0;
+  counters.priorTime = 0;
+  counters.likelihoodTime = 0;
+}
 
+double
+LogPosteriorDensity::now()
+{
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + 1e-6*tv.tv_usec;
 }
 
 /**
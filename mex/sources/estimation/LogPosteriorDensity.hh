@@ -26,6 +26,8 @@
 #if !defined(LPD_052A31B5_53BF_4904_AD80_863B52827973__INCLUDED_)
 #define LPD_052A31B5_53BF_4904_AD80_863B52827973__INCLUDED_
 
+#include <limits>
+
 #include "EstimatedParametersDescription.hh"
 #include "LogPriorDensity.hh"
 #include "LogLikelihoodMain.hh"
@@ -37,9 +39,23 @@
 class LogPosteriorDensity
 {
 
+public:
+  //! Statistics on the evaluations, to measure the computations saved by evaluating the prior first
+  struct Counters
+  {
+    size_t evaluations;
+    //! Evaluations stopped after the prior, because the prior density was zero (or not finite)
+    size_t priorShortCircuits;
+    //! Total wall-clock times, in seconds
+    double priorTime, likelihoodTime;
+  };
+
 private:
   LogPriorDensity logPriorDensity;
   LogLikelihoodMain logLikelihoodMain;
+  Counters counters;
+  //! Wall-clock time in seconds
+  static double now();
 
 public:
   virtual
@@ -49,18 +65,45 @@ public:
                       const std::vector<size_t> &zeta_fwrd_arg, const std::vector<size_t> &zeta_back_arg, const std::vector<size_t> &zeta_mixed_arg,
                       const std::vector<size_t> &zeta_static_arg, const double qz_criterium_arg, const std::vector<size_t> &varobs_arg,
                       double riccati_tol_arg, double lyapunov_tol_arg,
-                      bool noconstant_arg);
+                      bool noconstant_arg, size_t nThreads = ThreadPool::defaultNumWorkers());
 
   template <class VEC1, class VEC2>
   double
   compute(VEC1 &steadyState, VEC2 &estParams, VectorView &deepParams, const MatrixConstView &data, MatrixView &Q, Matrix &H, size_t presampleStart)
   {
-    return -logLikelihoodMain.compute(steadyState, estParams, deepParams, data, Q, H, presampleStart)
-      -logPriorDensity.compute(estParams);
+    counters.evaluations++;
+
+    // The prior is cheap: if the draw is impossible, the likelihood is not worth computing
+    double t0 = now();
+    double logPrior = logPriorDensity.compute(estParams);
+    double t1 = now();
+    counters.priorTime += t1 - t0;
+    if (!std::isfinite(logPrior))
+      {
+        counters.priorShortCircuits++;
+        return std::numeric_limits<double>::infinity();
+      }
+
+    double logLikelihood = logLikelihoodMain.compute(steadyState, estParams, deepParams, data, Q, H, presampleStart);
+    counters.likelihoodTime += now() - t1;
+    return -logLikelihood - logPrior;
   }
 
   Vector&getLikVector();
 
+  void
+  setModelSolutionOptions(const ModelSolution::Options &options)
+  {
+    logLikelihoodMain.setModelSolutionOptions(options);
+  };
+
+  const Counters &
+  getCounters() const
+  {
+    return counters;
+  };
+  void resetCounters();
+
 };
 
 #endif // !defined(052A31B5_53BF_4904_AD80_863B52827973__INCLUDED_)
@@ -29,7 +29,7 @@ LogPriorDensity::~LogPriorDensity()
 };
 
 LogPriorDensity::LogPriorDensity(EstimatedParametersDescription &estParsDesc_arg) :
-  estParsDesc(estParsDesc_arg)
+  estParsDesc(estParsDesc_arg), priorBlock(estParsDesc_arg.estParams)
 {
 };
 
@@ -29,6 +29,7 @@
 //#include <boost/random/variate_generator.hpp>
 #include "Vector.hh"
 #include "EstimatedParametersDescription.hh"
+#include "PriorBlock.hh"
 
 class LogPriorDensity
 {
@@ -43,20 +44,14 @@ public:
   compute(VEC &ep)
   {
     assert(estParsDesc.estParams.size() == ep.getSize());
-    double logPriorDensity = 0;
-    for (size_t i = 0; i <  ep.getSize(); ++i)
-      {
-        logPriorDensity += log(((*(estParsDesc.estParams[i]).prior)).pdf(ep(i)));
-        if (std::isinf(fabs(logPriorDensity)))
-          return logPriorDensity;
-      }
-    return logPriorDensity;
+    return priorBlock.compute(ep);
   };
 
   void computeNewParams(Vector &newParams);
 
 private:
   const EstimatedParametersDescription &estParsDesc;
+  PriorBlock priorBlock;
 
 };
 
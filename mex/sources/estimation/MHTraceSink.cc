@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+///////////////////////////////////////////////////////////
+//  MHTraceSink.cc
+//  Implementation of the Class MHTraceSink
+///////////////////////////////////////////////////////////
+
+#include <cassert>
+#include <sstream>
+#include <stdexcept>
+
+#include "MHTraceSink.hh"
+
+BufferedMHTraceSink::BufferedMHTraceSink(const std::string &prefix_arg, size_t nParams_arg, bool append_arg,
+                                         size_t bufferRecords_arg) :
+  prefix(prefix_arg), nParams(nParams_arg), recordSize(4 + nParams_arg), bufferRecords(bufferRecords_arg),
+  append(append_arg), buffer(recordSize*bufferRecords), nBuffered(0), file(NULL), currentChain(0)
+{
+  assert(bufferRecords > 0);
+}
+
+BufferedMHTraceSink::~BufferedMHTraceSink()
+{
+  try
+    {
+      flush();
+    }
+  catch (const std::runtime_error &)
+    {
+    }
+  if (file)
+    fclose(file);
+}
+
+std::string
+BufferedMHTraceSink::fileName(const std::string &prefix, size_t chain)
+{
+  std::ostringstream name;
+  name << prefix << "_chain" << chain + 1 << ".bin";
+  return name.str();
+}
+
+void
+BufferedMHTraceSink::record(size_t chain, size_t draw, double urand, double logPost, bool accepted,
+                            const Vector &proposal)
+{
+  assert(proposal.getSize() == nParams);
+  if (file == NULL || chain != currentChain)
+    {
+      flush();
+      if (file)
+        fclose(file);
+      currentChain = chain;
+      // Appending after the first opening, since a chain is run in several calls to the sampler
+      bool reopen = !openedChains.insert(chain).second;
+      file = fopen(fileName(prefix, chain).c_str(), append || reopen ? "ab" : "wb");
+      if (file == NULL)
+        throw std::runtime_error("Can not open the MH trace file " + fileName(prefix, chain));
+    }
+
+  double *r = &buffer[nBuffered*recordSize];
+  r[0] = (double) draw;
+  r[1] = urand;
+  r[2] = logPost;
+  r[3] = accepted ? 1.0 : 0.0;
+  for (size_t i = 0; i < nParams; i++)
+    r[4+i] = proposal(i);
+  if (++nBuffered == bufferRecords)
+    flush();
+}
+
+void
+BufferedMHTraceSink::flush()
+{
+  if (nBuffered == 0)
+    return;
+  size_t n = nBuffered;
+  nBuffered = 0;
+  if (fwrite(&buffer[0], sizeof(double)*recordSize, n, file) != n || fflush(file) != 0)
+    throw std::runtime_error("Can not write to the MH trace file " + fileName(prefix, currentChain));
+}
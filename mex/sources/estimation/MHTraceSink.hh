@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+///////////////////////////////////////////////////////////
+//  MHTraceSink.hh
+//  Implementation of the Class MHTraceSink
+///////////////////////////////////////////////////////////
+
+#if !defined(MHTS_0A5F83C2_6B1D_4E97_8C24_D9E31B7A6F50__INCLUDED_)
+#define MHTS_0A5F83C2_6B1D_4E97_8C24_D9E31B7A6F50__INCLUDED_
+
+#include <cstdio>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "Vector.hh"
+
+/**
+ * Receives a debugging trace of the Metropolis-Hastings sampler: one record
+ * per proposal, with the uniform number of its selection test. The sampler
+ * does not trace anything unless a sink is given to it.
+ *
+ * A sink is used by a single sampler, hence by one thread at a time.
+ */
+class MHTraceSink
+{
+public:
+  virtual ~MHTraceSink()
+  {
+  };
+  //! draw is the index of the proposal in the stream of the chain, counted over all the calls to the sampler, including those of earlier sessions resumed with load_mh_file
+  virtual void record(size_t chain, size_t draw, double urand, double logPost, bool accepted,
+                      const Vector &proposal) = 0;
+  virtual void flush() = 0;
+};
+
+/**
+ * Writes the trace of each chain to its own binary file <prefix>_chain<k>.bin
+ * (with k starting at 1), as records of 4+n doubles: the draw index, the
+ * uniform number, the log posterior of the proposal, 1 if it was accepted
+ * (else 0), and the n proposed parameters. In MATLAB, the trace is read with
+ * fread(fid, [4+n, Inf], 'double').
+ *
+ * The file of a chain is truncated when the sink first writes to it, unless
+ * append is set, e.g. when resuming the chains of a previous run.
+ *
+ * Records are accumulated in a buffer, written with a single fwrite when it
+ * is full, when the chain changes, and by flush().
+ */
+class BufferedMHTraceSink : public MHTraceSink
+{
+public:
+  BufferedMHTraceSink(const std::string &prefix_arg, size_t nParams_arg, bool append_arg = false,
+                      size_t bufferRecords_arg = 1024);
+  virtual ~BufferedMHTraceSink();
+  virtual void record(size_t chain, size_t draw, double urand, double logPost, bool accepted,
+                      const Vector &proposal);
+  virtual void flush();
+
+  static std::string fileName(const std::string &prefix, size_t chain);
+
+private:
+  const std::string prefix;
+  const size_t nParams, recordSize, bufferRecords;
+  const bool append;
+  //! Chains whose file has already been opened by this sink
+  std::set<size_t> openedChains;
+  std::vector<double> buffer;
+  size_t nBuffered;
+  FILE *file;
+  size_t currentChain;
+  // Not copyable
+  BufferedMHTraceSink(const BufferedMHTraceSink &);
+  BufferedMHTraceSink &operator=(const BufferedMHTraceSink &);
+};
+
+#endif // !defined(MHTS_0A5F83C2_6B1D_4E97_8C24_D9E31B7A6F50__INCLUDED_)
@@ -35,15 +35,30 @@ ModelSolution::ModelSolution(const std::string &basename,  size_t n_endo_arg, si
                              const std::vector<size_t> &zeta_static_arg, double INqz_criterium) :
   n_endo(n_endo_arg), n_exo(n_exo_arg),  // n_jcols = Num of Jacobian columns = nStat+2*nPred+3*nBoth+2*nForw+nExog
   n_jcols(n_exo+n_endo+ zeta_back_arg.size() /*nsPred*/ + zeta_fwrd_arg.size() /*nsForw*/ +2*zeta_mixed_arg.size()),
-  jacobian(n_endo, n_jcols), residual(n_endo), Mx(1, n_exo),
+  jacobian(n_endo, n_jcols), sparseJacobian(n_endo, n_jcols), useSparseJacobian(false),
+  residual(n_endo), Mx(1, n_exo),
   decisionRules(n_endo_arg, n_exo_arg, zeta_fwrd_arg, zeta_back_arg, zeta_mixed_arg, zeta_static_arg, INqz_criterium),
   dynamicDLLp(basename),
+  kernelInfo(dynamicDLLp.getKernelInfo()),
   steadyStateSolver(basename, n_endo),
-  llXsteadyState(n_jcols-n_exo)
+  llXsteadyState(n_jcols-n_exo),
+  jacobianStructureAnalyzed(false)
 {
   Mx.setAll(0.0);
   jacobian.setAll(0.0);
 
+  if (kernelInfo != NULL
+      && ((size_t) kernelInfo->endo_nbr != n_endo || (size_t) kernelInfo->exo_nbr != n_exo
+          || (size_t) kernelInfo->dynamic_jacobian_cols != n_jcols))
+    throw TSException(__FILE__, __LINE__, "The dimensions of the model kernel of " + basename
+                      + " don't match those of the model");
+
+  if (dynamicDLLp.hasSparseJacobian())
+    {
+      dynamicDLLp.getSparsePattern(sparseJacobian);
+      useSparseJacobian = true;
+    }
+
   set_union(zeta_fwrd_arg.begin(), zeta_fwrd_arg.end(),
             zeta_mixed_arg.begin(), zeta_mixed_arg.end(),
             back_inserter(zeta_fwrd_mixed));
@@ -39,19 +39,62 @@ class ModelSolution
 {
 
 public:
+  //! Optional behaviors, all off by default
+  struct Options
+  {
+    /*!
+      Detect the parameter-independent jacobian columns on the first call to
+      compute(), so that DecisionRules caches the blocks derived from them.
+      The detection costs two more steady state and jacobian evaluations, so
+      it only pays off for objects which solve the model many times, like
+      those of an MH chain.
+    */
+    bool analyzeJacobianStructure;
+    //! Check the closed form of the steady state, if any, see SteadyStateSolver::setCheckAnalyticSteadyState()
+    bool checkAnalyticSteadyState;
+    //! Restarts of the steady state solver after a failure, and threads running them, see SteadyStateSolver::setRecovery()
+    size_t steadyStateRecoveryStarts, steadyStateRecoveryThreads;
+    /*!
+      Always start the steady state solver from the given guess, instead of
+      the steady state of the nearest parameters already solved, so that the
+      result does not depend on the previous computations.
+    */
+    bool disableSteadyStateWarmStarts;
+    Options() : analyzeJacobianStructure(false), checkAnalyticSteadyState(false),
+                steadyStateRecoveryStarts(0), steadyStateRecoveryThreads(1), disableSteadyStateWarmStarts(false)
+    {
+    };
+  };
+
   ModelSolution(const std::string &basename,  size_t n_endo, size_t n_exo, const std::vector<size_t> &zeta_fwrd_arg,
                 const std::vector<size_t> &zeta_back_arg, const std::vector<size_t> &zeta_mixed_arg,
                 const std::vector<size_t> &zeta_static_arg, double qz_criterium);
   virtual ~ModelSolution()
   {
   };
+  void
+  setOptions(const Options &options_arg) throw (TSException)
+  {
+    options = options_arg;
+    steadyStateSolver.setCheckAnalyticSteadyState(options.checkAnalyticSteadyState);
+    steadyStateSolver.setRecovery(options.steadyStateRecoveryStarts, options.steadyStateRecoveryThreads);
+    steadyStateSolver.setWarmStartCacheSize(options.disableSteadyStateWarmStarts ? 0 : SteadyStateSolver::default_cache_capacity);
+  };
   template <class Vec1, class Vec2, class Mat1, class Mat2>
   void
-  compute(Vec1 &steadyState, const Vec2 &deepParams, Mat1 &ghx, Mat2 &ghu) throw (DecisionRules::BlanchardKahnException, GeneralizedSchurDecomposition::GSDException, SteadyStateSolver::SteadyStateException)
+  compute(Vec1 &steadyState, const Vec2 &deepParams, Mat1 &ghx, Mat2 &ghu) throw (DecisionRules::BlanchardKahnException, GeneralizedSchurDecomposition::GSDException, SteadyStateSolver::SteadyStateException, TSException)
   {
+    // A model kernel reads as many parameters as it was built with
+    if (kernelInfo != NULL && (size_t) kernelInfo->param_nbr != deepParams.getSize())
+      throw TSException(__FILE__, __LINE__, "The number of parameters of the model kernel doesn't match that of the model");
+
     // compute Steady State
     steadyStateSolver.compute(steadyState, Mx, deepParams);
 
+    // on first call, find the parameter-independent parts of the jacobian
+    if (options.analyzeJacobianStructure && !jacobianStructureAnalyzed)
+      analyzeJacobianStructure(steadyState, deepParams);
+
     // then get jacobian and
 
     ComputeModelSolution(steadyState, deepParams, ghx, ghu);
@@ -59,23 +102,92 @@ public:
   }
 
 private:
+  Options options;
   const size_t n_endo;
   const size_t n_exo;
   const size_t n_jcols; // Num of Jacobian columns
   std::vector<size_t> zeta_fwrd_mixed, zeta_back_mixed;
   Matrix jacobian;
+  //! Used instead of the dense jacobian if the DLL can compute it in sparse format
+  CSCMatrix sparseJacobian;
+  bool useSparseJacobian;
   Vector residual;
   Matrix Mx;
   DecisionRules decisionRules;
   DynamicModelDLL dynamicDLLp;
+  //! Description of the model kernel, NULL if the model is a MEX file
+  const dynare_model_kernel_info *kernelInfo;
   SteadyStateSolver steadyStateSolver;
   Vector llXsteadyState;
+  bool jacobianStructureAnalyzed;
   //Matrix jacobian;
   template <class Vec1, class Vec2, class Mat1, class Mat2>
   void
   ComputeModelSolution(Vec1 &steadyState, const Vec2 &deepParams,
                        Mat1 &ghx, Mat2 &ghu)
     throw (DecisionRules::BlanchardKahnException, GeneralizedSchurDecomposition::GSDException)
+  {
+    //get jacobian
+    evalJacobian(steadyState, deepParams);
+
+    //compute rules
+    if (useSparseJacobian)
+      decisionRules.compute(sparseJacobian, ghx, ghu);
+    else
+      decisionRules.compute(jacobian, ghx, ghu);
+  }
+
+  /**
+   * Detects the jacobian columns which do not depend on the deep parameters,
+   * by comparing jacobians evaluated at perturbed parameter values (and at the
+   * corresponding steady states), so that DecisionRules can cache the blocks
+   * derived from them. Done only once; DecisionRules drops the cache if a
+   * later jacobian contradicts it.
+   */
+  template <class Vec1, class Vec2>
+  void
+  analyzeJacobianStructure(const Vec1 &steadyState, const Vec2 &deepParams)
+  {
+    jacobianStructureAnalyzed = true;
+
+    evalJacobian(steadyState, deepParams);
+    if (useSparseJacobian)
+      mat::set_dense(jacobian, sparseJacobian);
+    Matrix refJacobian(jacobian);
+    std::vector<bool> constantCols(n_jcols, true);
+
+    Vector perturbedParams(deepParams.getSize()), perturbedSteadyState(n_endo);
+    const double steps[] = { 1e-4, -3e-4 };
+    for (size_t k = 0; k < 2; k++)
+      {
+        // Perturb every parameter by a different relative amount
+        for (size_t i = 0; i < deepParams.getSize(); i++)
+          perturbedParams(i) = deepParams(i)*(1 + steps[k]*(1 + i % 7)) + steps[k];
+        perturbedSteadyState = steadyState;
+        try
+          {
+            steadyStateSolver.compute(perturbedSteadyState, Mx, perturbedParams);
+          }
+        catch (SteadyStateSolver::SteadyStateException &e)
+          {
+            // Cannot conclude: nothing will be cached
+            return;
+          }
+        evalJacobian(perturbedSteadyState, perturbedParams);
+        if (useSparseJacobian)
+          mat::set_dense(jacobian, sparseJacobian);
+
+        for (size_t j = 0; j < n_jcols; j++)
+          for (size_t i = 0; i < n_endo && constantCols[j]; i++)
+            constantCols[j] = (jacobian(i, j) == refJacobian(i, j));
+      }
+
+    decisionRules.setConstantColumns(refJacobian, constantCols);
+  }
+
+  template <class Vec1, class Vec2>
+  void
+  evalJacobian(const Vec1 &steadyState, const Vec2 &deepParams)
   {
     // set extended Steady State
 
@@ -88,11 +200,10 @@ private:
     for (size_t i = 0; i < zeta_fwrd_mixed.size(); i++)
       llXsteadyState(zeta_back_mixed.size() + n_endo + i) = steadyState(zeta_fwrd_mixed[i]);
 
-    //get jacobian
-    dynamicDLLp.eval(llXsteadyState, Mx, deepParams, steadyState, residual, &jacobian, NULL, NULL);
-
-    //compute rules
-    decisionRules.compute(jacobian, ghx, ghu);
+    if (useSparseJacobian)
+      dynamicDLLp.evalSparse(llXsteadyState, Mx, deepParams, steadyState, residual, sparseJacobian);
+    else
+      dynamicDLLp.eval(llXsteadyState, Mx, deepParams, steadyState, residual, &jacobian, NULL, NULL);
   }
 };
 
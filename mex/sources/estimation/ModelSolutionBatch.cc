@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+///////////////////////////////////////////////////////////
+//  ModelSolutionBatch.cc
+//  Implementation of the Class ModelSolutionBatch
+///////////////////////////////////////////////////////////
+
+#include "ModelSolutionBatch.hh"
+
+ModelSolutionBatch::Slot::Slot(const std::string &basename, size_t n_endo, size_t n_exo, const std::vector<size_t> &zeta_fwrd_arg,
+                               const std::vector<size_t> &zeta_back_arg, const std::vector<size_t> &zeta_mixed_arg,
+                               const std::vector<size_t> &zeta_static_arg, double qz_criterium) :
+  modelSolution(basename, n_endo, n_exo, zeta_fwrd_arg, zeta_back_arg, zeta_mixed_arg, zeta_static_arg, qz_criterium),
+  ghx(n_endo, zeta_back_arg.size() + zeta_mixed_arg.size()), ghu(n_endo, n_exo)
+{
+  // The results must not depend on the vectors solved before by the slot
+  ModelSolution::Options options;
+  options.disableSteadyStateWarmStarts = true;
+  modelSolution.setOptions(options);
+}
+
+ModelSolutionBatch::ModelSolutionBatch(const std::string &basename, size_t n_endo_arg, size_t n_exo_arg,
+                                       const std::vector<size_t> &zeta_fwrd_arg, const std::vector<size_t> &zeta_back_arg,
+                                       const std::vector<size_t> &zeta_mixed_arg, const std::vector<size_t> &zeta_static_arg,
+                                       double qz_criterium, size_t nSlots) :
+  n_endo(n_endo_arg), n_exo(n_exo_arg), n_back_mixed(zeta_back_arg.size() + zeta_mixed_arg.size()),
+  pool(nSlots)
+{
+  try
+    {
+      for (size_t i = 0; i < nSlots; i++)
+        slots.push_back(new Slot(basename, n_endo, n_exo, zeta_fwrd_arg, zeta_back_arg, zeta_mixed_arg,
+                                 zeta_static_arg, qz_criterium));
+    }
+  catch (...)
+    {
+      for (size_t i = 0; i < slots.size(); i++)
+        delete slots[i];
+      throw;
+    }
+}
+
+ModelSolutionBatch::~ModelSolutionBatch()
+{
+  for (size_t i = 0; i < slots.size(); i++)
+    delete slots[i];
+}
+
+void
+ModelSolutionBatch::compute(const Matrix &deepParams, Matrix &steadyStates, Matrix &ghx, Matrix &ghu,
+                            std::vector<int> &status) throw (TSException)
+{
+  size_t nDraws = deepParams.getCols();
+  assert(steadyStates.getRows() == n_endo && steadyStates.getCols() == nDraws);
+  assert(ghx.getRows() == n_endo && ghx.getCols() == nDraws*n_back_mixed);
+  assert(ghu.getRows() == n_endo && ghu.getCols() == nDraws*n_exo);
+
+  status.assign(nDraws, OTHER_FAILURE);
+  SolveTask task(*this, deepParams, steadyStates, ghx, ghu, status);
+  pool.run(task, nDraws);
+}
+
+void
+ModelSolutionBatch::SolveTask::run(size_t item, size_t worker)
+{
+  Slot &slot = *batch.slots[worker];
+  VectorConstView params = mat::get_col(deepParams, item);
+  VectorView steadyState = mat::get_col(steadyStates, item);
+
+  try
+    {
+      slot.modelSolution.compute(steadyState, params, slot.ghx, slot.ghu);
+      if (batch.n_back_mixed > 0)
+        MatrixView(ghx, 0, item*batch.n_back_mixed, batch.n_endo, batch.n_back_mixed) = slot.ghx;
+      if (batch.n_exo > 0)
+        MatrixView(ghu, 0, item*batch.n_exo, batch.n_endo, batch.n_exo) = slot.ghu;
+      status[item] = OK;
+    }
+  catch (SteadyStateSolver::SteadyStateException &e)
+    {
+      status[item] = STEADY_STATE_FAILURE;
+    }
+  catch (DecisionRules::BlanchardKahnException &e)
+    {
+      status[item] = e.order ? BK_ORDER_FAILURE : BK_RANK_FAILURE;
+    }
+  catch (GeneralizedSchurDecomposition::GSDException &e)
+    {
+      status[item] = GSD_FAILURE;
+    }
+  catch (TSException &e)
+    {
+      status[item] = DLL_FAILURE;
+    }
+  catch (...)
+    {
+      status[item] = OTHER_FAILURE;
+    }
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+///////////////////////////////////////////////////////////
+//  ModelSolutionBatch.hh
+//  Implementation of the Class ModelSolutionBatch
+///////////////////////////////////////////////////////////
+
+#if !defined(MSB_3E1C9A52_7D4B_4F0A_9C61_2B8E5D7A1F34__INCLUDED_)
+#define MSB_3E1C9A52_7D4B_4F0A_9C61_2B8E5D7A1F34__INCLUDED_
+
+#include <vector>
+
+#include "ModelSolution.hh"
+#include "thread_pool.hh"
+
+/**
+ * Computes the steady state and the first order decision rules for many
+ * parameter vectors at once, using a pool of threads.
+ *
+ * Each slot (one per worker thread) owns a complete ModelSolution, i.e. its
+ * own DLL handles, steady state solver and decision rules workspaces. A
+ * failure for one parameter vector is reported in its status code, and does
+ * not interrupt the other ones.
+ *
+ * The steady state of each vector is computed from its own initial guess,
+ * without warm starts from the vectors solved before, so that the results do
+ * not depend on the number of slots nor on the order of the computations.
+ */
+class ModelSolutionBatch
+{
+public:
+  enum Status
+  {
+    OK = 0,
+    STEADY_STATE_FAILURE,
+    BK_ORDER_FAILURE, //!< Blanchard-Kahn order condition not satisfied
+    BK_RANK_FAILURE, //!< Blanchard-Kahn rank condition not satisfied
+    GSD_FAILURE, //!< Generalized Schur decomposition failed
+    DLL_FAILURE, //!< Error in the model DLL
+    OTHER_FAILURE
+  };
+
+  /**
+   * \param nSlots Number of parameter vectors processed concurrently (a value of 1 means a serial computation)
+   */
+  ModelSolutionBatch(const std::string &basename, size_t n_endo, size_t n_exo, const std::vector<size_t> &zeta_fwrd_arg,
+                     const std::vector<size_t> &zeta_back_arg, const std::vector<size_t> &zeta_mixed_arg,
+                     const std::vector<size_t> &zeta_static_arg, double qz_criterium, size_t nSlots);
+  virtual ~ModelSolutionBatch();
+
+  size_t
+  getNumSlots() const
+  {
+    return slots.size();
+  };
+
+  /**
+   * Solves the model for every column of deepParams.
+   * \param[in] deepParams One parameter vector per column
+   * \param[in,out] steadyStates One column per parameter vector: initial guess on input, steady state on output
+   * \param[out] ghx Decision rules w.r. to state variables, the block for vector i starts at column i*(n_back+n_mixed)
+   * \param[out] ghu Decision rules w.r. to shocks, the block for vector i starts at column i*n_exo
+   * \param[out] status One Status code per parameter vector; outputs of failed vectors are unspecified
+   */
+  void compute(const Matrix &deepParams, Matrix &steadyStates, Matrix &ghx, Matrix &ghu,
+               std::vector<int> &status) throw (TSException);
+
+private:
+  struct Slot
+  {
+    ModelSolution modelSolution;
+    Matrix ghx, ghu;
+    Slot(const std::string &basename, size_t n_endo, size_t n_exo, const std::vector<size_t> &zeta_fwrd_arg,
+         const std::vector<size_t> &zeta_back_arg, const std::vector<size_t> &zeta_mixed_arg,
+         const std::vector<size_t> &zeta_static_arg, double qz_criterium);
+  };
+
+  class SolveTask : public ThreadPool::Task
+  {
+  public:
+    ModelSolutionBatch &batch;
+    const Matrix &deepParams;
+    Matrix &steadyStates, &ghx, &ghu;
+    std::vector<int> &status;
+    SolveTask(ModelSolutionBatch &batch_arg, const Matrix &deepParams_arg, Matrix &steadyStates_arg,
+              Matrix &ghx_arg, Matrix &ghu_arg, std::vector<int> &status_arg) :
+      batch(batch_arg), deepParams(deepParams_arg), steadyStates(steadyStates_arg),
+      ghx(ghx_arg), ghu(ghu_arg), status(status_arg)
+    {
+    };
+    virtual void run(size_t item, size_t worker);
+  };
+
+  const size_t n_endo, n_exo, n_back_mixed;
+  std::vector<Slot *> slots;
+  ThreadPool pool;
+};
+
+#endif // !defined(MSB_3E1C9A52_7D4B_4F0A_9C61_2B8E5D7A1F34__INCLUDED_)
@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+///////////////////////////////////////////////////////////
+//  NewtonSolver.cc
+//  Implementation of the Class NewtonSolver
+///////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <limits>
+
+#include "NewtonSolver.hh"
+#include "BlasBindings.hh"
+
+const double NewtonSolver::contraction = 0.5;
+
+NewtonSolver::NewtonSolver(size_t n_arg, double tolerance_arg, size_t maxIterations_arg) :
+  n(n_arg), tolerance(tolerance_arg), maxIterations(maxIterations_arg),
+  x(n), F(n), xTrial(n), FTrial(n), step(n), newtonStep(n), gradient(n), tmp(n),
+  J(n), LU(n), luSolver(n), broydenA(n, maxBroydenUpdates), broydenB(n, maxBroydenUpdates), nBroyden(0),
+  iterations(0), jacobianEvaluations(0)
+{
+}
+
+bool
+NewtonSolver::converged(const Vector &v) const
+{
+  double sum = 0;
+  for (size_t i = 0; i < n; i++)
+    sum += fabs(v(i));
+  return sum < tolerance;
+}
+
+void
+NewtonSolver::applyInverse(Vector &v)
+{
+  MatrixView vm(v.getData(), n, 1, n);
+  luSolver.solve("N", LU, vm);
+  for (size_t i = 0; i < nBroyden; i++)
+    {
+      VectorView a = mat::get_col(broydenA, i), b = mat::get_col(broydenB, i);
+      double c = blas::dot(b, v);
+      for (size_t j = 0; j < n; j++)
+        v(j) += c*a(j);
+    }
+}
+
+bool
+NewtonSolver::broydenUpdate()
+{
+  if (nBroyden == maxBroydenUpdates)
+    return false;
+
+  // "Good" Broyden update of the inverse: with s the step, y the change in residuals and h = J^(-1)*y,
+  // J^(-1) becomes (I + (s-h)*s'/(s'*h)) * J^(-1)
+  for (size_t i = 0; i < n; i++)
+    tmp(i) = FTrial(i) - F(i);
+  applyInverse(tmp);
+  double sh = blas::dot(step, tmp);
+  double ss = blas::dot(step, step), hh = blas::dot(tmp, tmp);
+  if (!(fabs(sh) > std::numeric_limits<double>::epsilon() * sqrt(ss*hh)))
+    return false;
+
+  VectorView a = mat::get_col(broydenA, nBroyden), b = mat::get_col(broydenB, nBroyden);
+  for (size_t i = 0; i < n; i++)
+    {
+      a(i) = (step(i) - tmp(i)) / sh;
+      b(i) = step(i);
+    }
+  nBroyden++;
+  return true;
+}
+
+void
+NewtonSolver::doglegStep(double delta, bool haveNewtonStep)
+{
+  if (haveNewtonStep && sqrt(blas::dot(newtonStep, newtonStep)) <= delta)
+    {
+      step = newtonStep;
+      return;
+    }
+
+  // Minimizer of the linear model along the steepest descent direction (Cauchy point)
+  double gnorm2 = blas::dot(gradient, gradient);
+  blas::gemv("N", 1.0, J, gradient, 0.0, tmp);
+  double alpha = gnorm2 / blas::dot(tmp, tmp);
+  double cauchyNorm = alpha*sqrt(gnorm2);
+
+  if (!haveNewtonStep || cauchyNorm >= delta)
+    {
+      double scale = (haveNewtonStep ? delta : std::min(delta, cauchyNorm)) / sqrt(gnorm2);
+      for (size_t i = 0; i < n; i++)
+        step(i) = -scale*gradient(i);
+      return;
+    }
+
+  // Intersection of the segment from the Cauchy point to the Newton step with the trust-region boundary
+  double a = 0, b = 0;
+  for (size_t i = 0; i < n; i++)
+    {
+      double d = newtonStep(i) + alpha*gradient(i);
+      a += d*d;
+      b -= 2*alpha*gradient(i)*d;
+    }
+  double c = cauchyNorm*cauchyNorm - delta*delta;
+  double t = (-b + sqrt(b*b - 4*a*c)) / (2*a);
+  for (size_t i = 0; i < n; i++)
+    step(i) = -alpha*gradient(i) + t*(newtonStep(i) + alpha*gradient(i));
+}
+
+bool
+NewtonSolver::solveImpl(System &system)
+{
+  iterations = 0;
+  jacobianEvaluations = 0;
+  nBroyden = 0;
+
+  system.residuals(x, F);
+  double fnorm2 = blas::dot(F, F);
+  if (!std::isfinite(fnorm2))
+    return false;
+  if (converged(F))
+    return true;
+
+  bool factorized = false, quasiNewton = false;
+  double delta = 0;
+
+  while (iterations < maxIterations)
+    {
+      iterations++;
+
+      if (quasiNewton)
+        {
+          // Reuse the factorization, as long as the residuals decrease fast enough
+          step = F;
+          applyInverse(step);
+          vec::negate(step);
+          for (size_t i = 0; i < n; i++)
+            xTrial(i) = x(i) + step(i);
+          system.residuals(xTrial, FTrial);
+          double fnorm2Trial = blas::dot(FTrial, FTrial);
+          if (std::isfinite(fnorm2Trial) && fnorm2Trial <= contraction*contraction*fnorm2)
+            {
+              quasiNewton = broydenUpdate();
+              x = xTrial;
+              F = FTrial;
+              fnorm2 = fnorm2Trial;
+              if (converged(F))
+                return true;
+              continue;
+            }
+          quasiNewton = false;
+          if (iterations == maxIterations)
+            break;
+          iterations++;
+        }
+
+      // Trust-region step, with a fresh jacobian
+      system.jacobian(x, F, J);
+      jacobianEvaluations++;
+      LU = J;
+      nBroyden = 0;
+      try
+        {
+          luSolver.factorize(LU);
+          factorized = true;
+          newtonStep = F;
+          applyInverse(newtonStep);
+          vec::negate(newtonStep);
+        }
+      catch (LUSolver::LUException &e)
+        {
+          // Singular jacobian: only use the steepest descent direction
+          factorized = false;
+        }
+
+      blas::gemv("T", 1.0, J, F, 0.0, gradient);
+      if (blas::dot(gradient, gradient) == 0)
+        return false; // Stationary point of the sum of squares, which is not a solution
+
+      if (delta == 0)
+        {
+          double xnorm = sqrt(blas::dot(x, x));
+          delta = 100*(xnorm > 0 ? xnorm : 1);
+        }
+
+      while (true)
+        {
+          doglegStep(delta, factorized);
+          double stepNorm = sqrt(blas::dot(step, step));
+
+          // Reduction of the sum of squares predicted by the linear model
+          tmp = F;
+          blas::gemv("N", 1.0, J, step, 1.0, tmp);
+          double predicted = fnorm2 - blas::dot(tmp, tmp);
+
+          for (size_t i = 0; i < n; i++)
+            xTrial(i) = x(i) + step(i);
+          system.residuals(xTrial, FTrial);
+          double fnorm2Trial = blas::dot(FTrial, FTrial);
+          double ratio = std::isfinite(fnorm2Trial) && predicted > 0 ? (fnorm2 - fnorm2Trial) / predicted : -1;
+
+          if (ratio < 0.25)
+            delta = 0.25*stepNorm;
+          else if (ratio > 0.75 && 2*stepNorm > delta)
+            delta = 2*stepNorm;
+
+          if (ratio > 1e-4)
+            {
+              quasiNewton = factorized && broydenUpdate();
+              x = xTrial;
+              F = FTrial;
+              fnorm2 = fnorm2Trial;
+              if (converged(F))
+                return true;
+              break;
+            }
+
+          if (delta <= std::numeric_limits<double>::epsilon()*sqrt(blas::dot(x, x)) || iterations >= maxIterations)
+            return false;
+          iterations++;
+        }
+    }
+
+  return false;
+}
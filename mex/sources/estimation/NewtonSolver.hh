@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+///////////////////////////////////////////////////////////
+//  NewtonSolver.hh
+//  Implementation of the Class NewtonSolver
+///////////////////////////////////////////////////////////
+
+#if !defined(NS_4C7B2E91_0D6A_4E3F_B852_9A1F6C3D8E27__INCLUDED_)
+#define NS_4C7B2E91_0D6A_4E3F_B852_9A1F6C3D8E27__INCLUDED_
+
+#include "Vector.hh"
+#include "Matrix.hh"
+#include "LUSolver.hh"
+
+/**
+ * Solves a square nonlinear system F(x)=0 by a trust-region (Powell's
+ * dogleg) Newton method, with quasi-Newton steps in between jacobian
+ * evaluations.
+ *
+ * The jacobian is in column-major order, and is factorized with LUSolver.
+ * As long as the residuals shrink fast enough, the factorization is reused
+ * across iterations, and corrected by Broyden updates stored in product
+ * form; otherwise the jacobian is evaluated again and a trust-region step is
+ * taken.
+ *
+ * All the workspace is allocated at construction, so that solving does not
+ * allocate memory. The convergence criterion is the same as the one of
+ * gsl_multiroot_test_residual(): the sum of the absolute values of the
+ * residuals must be below the tolerance.
+ */
+class NewtonSolver
+{
+public:
+  //! The system to be solved
+  class System
+  {
+  public:
+    virtual ~System()
+    {
+    };
+    //! Evaluates the residuals F(x)
+    virtual void residuals(const Vector &x, Vector &F) = 0;
+    //! Evaluates the residuals and the jacobian (in column-major order)
+    virtual void jacobian(const Vector &x, Vector &F, Matrix &J) = 0;
+  };
+
+  NewtonSolver(size_t n_arg, double tolerance_arg, size_t maxIterations_arg);
+  virtual ~NewtonSolver()
+  {
+  };
+
+  /**
+   * Solves the system, starting from the value of x.
+   * \return whether a solution was found; x holds the solution, or is left unchanged in case of failure
+   */
+  template<class Vec>
+  bool
+  solve(System &system, Vec &x0)
+  {
+    assert(x0.getSize() == n);
+    x = x0;
+    if (!solveImpl(system))
+      return false;
+    x0 = x;
+    return true;
+  };
+
+  //! Number of iterations of the last call to solve()
+  size_t
+  getIterations() const
+  {
+    return iterations;
+  };
+
+  //! Number of jacobian evaluations of the last call to solve()
+  size_t
+  getJacobianEvaluations() const
+  {
+    return jacobianEvaluations;
+  };
+
+private:
+  const size_t n;
+  const double tolerance;
+  const size_t maxIterations;
+
+  //! Maximal number of Broyden updates of a factorization, before the jacobian is evaluated again
+  static const size_t maxBroydenUpdates = 10;
+  //! Minimal reduction of the norm of the residuals for a quasi-Newton step to be accepted
+  static const double contraction;
+
+  Vector x, F, xTrial, FTrial, step, newtonStep, gradient, tmp;
+  Matrix J, LU;
+  LUSolver luSolver;
+  //! Broyden updates: the inverse of the current jacobian is prod_i (I + a_i*b_i') * LU^(-1)
+  Matrix broydenA, broydenB;
+  size_t nBroyden;
+
+  size_t iterations, jacobianEvaluations;
+
+  bool solveImpl(System &system);
+  //! Replaces v by the inverse of the current (approximated) jacobian times v
+  void applyInverse(Vector &v);
+  //! Records the Broyden update for the step s=xTrial-x, returns false if it is ill-conditioned
+  bool broydenUpdate();
+  //! Computes the dogleg step for the given trust-region radius
+  void doglegStep(double delta, bool haveNewtonStep);
+  bool converged(const Vector &v) const;
+};
+
+#endif // !defined(NS_4C7B2E91_0D6A_4E3F_B852_9A1F6C3D8E27__INCLUDED_)
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+///////////////////////////////////////////////////////////
+//  ParameterTransform.cc
+//  Implementation of the Class ParameterTransform
+///////////////////////////////////////////////////////////
+
+#include <algorithm>
+
+#include "ParameterTransform.hh"
+
+ParameterTransform::ParameterTransform(const std::vector<EstimatedParameter> &estParams)
+{
+  for (size_t i = 0; i < estParams.size(); i++)
+    {
+      const Prior &prior = *estParams[i].prior;
+      double low = estParams[i].lower_bound, up = estParams[i].upper_bound;
+
+      // Intersect with the support of the prior density
+      switch (const_cast<Prior &>(prior).getShape())
+        {
+        case Prior::Gamma:
+        case Prior::Inv_gamma_1:
+        case Prior::Inv_gamma_2:
+          low = std::max(low, prior.lower_bound);
+          break;
+        case Prior::Uniform:
+          low = std::max(low, std::max(prior.lower_bound, prior.fhp));
+          up = std::min(up, std::min(prior.upper_bound, prior.shp));
+          break;
+        default:
+          low = std::max(low, prior.lower_bound);
+          up = std::min(up, prior.upper_bound);
+          break;
+        }
+
+      Kind kind = Identity;
+      if (std::isfinite(low) && std::isfinite(up))
+        kind = Bounded;
+      else if (std::isfinite(low))
+        kind = LowerBounded;
+      else if (std::isfinite(up))
+        kind = UpperBounded;
+
+      kinds.push_back(kind);
+      lb.push_back(low);
+      ub.push_back(up);
+      logRange.push_back(kind == Bounded ? log(up - low) : 0);
+    }
+}
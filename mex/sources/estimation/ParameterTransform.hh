@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+///////////////////////////////////////////////////////////
+//  ParameterTransform.hh
+//  Implementation of the Class ParameterTransform
+///////////////////////////////////////////////////////////
+
+#if !defined(PT_93B0E6D2_1F4A_4C8E_B57D_2A6C0F84E913__INCLUDED_)
+#define PT_93B0E6D2_1F4A_4C8E_B57D_2A6C0F84E913__INCLUDED_
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include "EstimatedParameter.hh"
+#include "Prior.hh"
+
+/**
+ * Maps the estimated parameters to an unconstrained space, so that samplers
+ * and optimizers do not waste evaluations on values outside of the support.
+ *
+ * The support of each parameter is the intersection of its estimation bounds
+ * with the support of its prior. A parameter bounded on both sides is mapped
+ * with a scaled logit, a parameter bounded on one side with a logarithm, and
+ * an unbounded parameter is left unchanged.
+ *
+ * A density of the constrained parameters x = g(u) becomes, in the
+ * unconstrained space, its value at g(u) times |det g'(u)|; logJacobian()
+ * returns the log of the latter term.
+ */
+class ParameterTransform
+{
+public:
+  enum Kind
+    {
+      Identity = 0, // unbounded: x = u
+      LowerBounded = 1, // x = lb + exp(u)
+      UpperBounded = 2, // x = ub - exp(u)
+      Bounded = 3 // x = lb + (ub-lb)/(1+exp(-u))
+    };
+
+  ParameterTransform(const std::vector<EstimatedParameter> &estParams);
+  virtual ~ParameterTransform()
+  {
+  };
+
+  size_t
+  getSize() const
+  {
+    return kinds.size();
+  };
+  Kind
+  getKind(size_t i) const
+  {
+    return kinds[i];
+  };
+  double
+  getLowerBound(size_t i) const
+  {
+    return lb[i];
+  };
+  double
+  getUpperBound(size_t i) const
+  {
+    return ub[i];
+  };
+
+  double
+  toConstrained(size_t i, double u) const
+  {
+    switch (kinds[i])
+      {
+      case LowerBounded:
+        return lb[i] + exp(u);
+      case UpperBounded:
+        return ub[i] - exp(u);
+      case Bounded:
+        return lb[i] + (ub[i]-lb[i])/(1+exp(-u));
+      default:
+        return u;
+      }
+  };
+
+  double
+  toUnconstrained(size_t i, double x) const
+  {
+    double s;
+    switch (kinds[i])
+      {
+      case LowerBounded:
+        return log(x - lb[i]);
+      case UpperBounded:
+        return log(ub[i] - x);
+      case Bounded:
+        s = (x - lb[i])/(ub[i]-lb[i]);
+        return log(s) - log1p(-s);
+      default:
+        return x;
+      }
+  };
+
+  //! Log of the derivative of toConstrained(i, .) at u
+  double
+  logDerivative(size_t i, double u) const
+  {
+    switch (kinds[i])
+      {
+      case LowerBounded:
+      case UpperBounded:
+        return u;
+      case Bounded:
+        // log(ub-lb) + log(s) + log(1-s), which is symmetric in u
+        return logRange[i] - fabs(u) - 2*log1p(exp(-fabs(u)));
+      default:
+        return 0;
+      }
+  };
+
+  template<class VEC1, class VEC2>
+  void
+  toConstrained(const VEC1 &u, VEC2 &x) const
+  {
+    assert(u.getSize() == kinds.size() && x.getSize() == kinds.size());
+    for (size_t i = 0; i < kinds.size(); i++)
+      x(i) = toConstrained(i, u(i));
+  };
+
+  template<class VEC1, class VEC2>
+  void
+  toUnconstrained(const VEC1 &x, VEC2 &u) const
+  {
+    assert(u.getSize() == kinds.size() && x.getSize() == kinds.size());
+    for (size_t i = 0; i < kinds.size(); i++)
+      u(i) = toUnconstrained(i, x(i));
+  };
+
+  //! Log of the absolute value of the Jacobian determinant of toConstrained() at u
+  template<class VEC>
+  double
+  logJacobian(const VEC &u) const
+  {
+    assert(u.getSize() == kinds.size());
+    double logJ = 0;
+    for (size_t i = 0; i < kinds.size(); i++)
+      logJ += logDerivative(i, u(i));
+    return logJ;
+  };
+
+private:
+  std::vector<Kind> kinds;
+  std::vector<double> lb, ub, logRange;
+};
+
+#endif // !defined(PT_93B0E6D2_1F4A_4C8E_B57D_2A6C0F84E913__INCLUDED_)
@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+///////////////////////////////////////////////////////////
+//  PriorBlock.cc
+//  Implementation of the Class PriorBlock
+///////////////////////////////////////////////////////////
+
+#include <cmath>
+#include <limits>
+
+#include "PriorBlock.hh"
+
+namespace
+{
+  //! c*log(y), with the convention 0*log(0) = 0
+  inline double
+  xlogy(double c, double y)
+  {
+    return c == 0 ? 0 : c*log(y);
+  }
+}
+
+PriorBlock::PriorBlock(const std::vector<EstimatedParameter> &estParams) :
+  size(estParams.size())
+{
+  const double log2pi = log(2*M_PI);
+
+  for (size_t i = 0; i < size; i++)
+    {
+      const Prior &prior = *estParams[i].prior;
+      Prior::pShape shape = const_cast<Prior &>(prior).getShape();
+
+      size_t f = 0;
+      while (f < families.size() && families[f].shape != shape)
+        f++;
+      if (f == families.size())
+        {
+          families.push_back(Family());
+          families[f].shape = shape;
+        }
+      Family &family = families[f];
+
+      double lb = prior.lower_bound, ub = prior.upper_bound, c1 = 0, c2 = 0, c3 = 0, logConst = 0;
+      double alpha, logBeta;
+      switch (shape)
+        {
+        case Prior::Beta:
+          c1 = prior.fhp - 1;
+          c2 = prior.shp - 1;
+          if (lb || 1.0-ub)
+            c3 = 1/(ub-lb);
+          else
+            {
+              lb = 0;
+              c3 = 1;
+            }
+          logConst = lgamma(prior.fhp + prior.shp) - lgamma(prior.fhp) - lgamma(prior.shp);
+          break;
+        case Prior::Gamma:
+          c1 = prior.fhp - 1;
+          c2 = 1/prior.shp;
+          logConst = -lgamma(prior.fhp) - prior.fhp*log(prior.shp);
+          break;
+        case Prior::Inv_gamma_1:
+        case Prior::Inv_gamma_2:
+          // 1/x^2 (resp. 1/x) follows a gamma distribution of shape nu/2 and scale 2/s
+          alpha = prior.shp/2;
+          logBeta = log(2/prior.fhp);
+          c1 = shape == Prior::Inv_gamma_1 ? -(2*alpha+1) : -(alpha+1);
+          c2 = prior.fhp/2;
+          logConst = -lgamma(alpha) - alpha*logBeta;
+          if (shape == Prior::Inv_gamma_1)
+            logConst += log(2.0);
+          break;
+        case Prior::Gaussian:
+          c1 = prior.fhp;
+          c2 = 1/prior.shp;
+          logConst = -log(prior.shp) - 0.5*log2pi;
+          break;
+        case Prior::Uniform:
+          c1 = prior.fhp;
+          c2 = prior.shp;
+          logConst = -log(prior.shp - prior.fhp);
+          break;
+        }
+
+      family.index.push_back(i);
+      family.x.push_back(0);
+      family.lb.push_back(lb);
+      family.ub.push_back(ub);
+      family.c1.push_back(c1);
+      family.c2.push_back(c2);
+      family.c3.push_back(c3);
+      family.logConst.push_back(logConst);
+    }
+}
+
+double
+PriorBlock::evalFamily(Family &family, bool &outside)
+{
+  const size_t n = family.index.size();
+  const double *x = &family.x[0], *lb = &family.lb[0], *ub = &family.ub[0],
+    *c1 = &family.c1[0], *c2 = &family.c2[0], *c3 = &family.c3[0], *logConst = &family.logConst[0];
+
+  // The support is checked alongside the sum, so that the loops have no early exit
+  double sum = 0;
+  bool out = false;
+  switch (family.shape)
+    {
+    case Prior::Beta:
+      for (size_t k = 0; k < n; k++)
+        {
+          double s = (x[k] - lb[k])*c3[k];
+          out |= !(s >= 0 && s <= 1);
+          sum += logConst[k] + xlogy(c1[k], s) + (c2[k] == 0 ? 0 : c2[k]*log1p(-s));
+        }
+      break;
+    case Prior::Gamma:
+      for (size_t k = 0; k < n; k++)
+        {
+          double y = x[k] - lb[k];
+          out |= !(y >= 0);
+          sum += logConst[k] + xlogy(c1[k], y) - y*c2[k];
+        }
+      break;
+    case Prior::Inv_gamma_1:
+      for (size_t k = 0; k < n; k++)
+        {
+          double u = x[k] - lb[k];
+          out |= !(u > 0);
+          sum += logConst[k] + c1[k]*log(u) - c2[k]/(u*u);
+        }
+      break;
+    case Prior::Inv_gamma_2:
+      for (size_t k = 0; k < n; k++)
+        {
+          double u = x[k] - lb[k];
+          out |= !(u > 0);
+          sum += logConst[k] + c1[k]*log(u) - c2[k]/u;
+        }
+      break;
+    case Prior::Gaussian:
+      for (size_t k = 0; k < n; k++)
+        {
+          double z = (x[k] - c1[k])*c2[k];
+          out |= !(x[k] > lb[k] && x[k] < ub[k]);
+          sum += logConst[k] - 0.5*z*z;
+        }
+      break;
+    case Prior::Uniform:
+      for (size_t k = 0; k < n; k++)
+        {
+          out |= !(x[k] > lb[k] && x[k] < ub[k] && x[k] >= c1[k] && x[k] <= c2[k]);
+          sum += logConst[k];
+        }
+      break;
+    }
+  outside |= out;
+  return sum;
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+///////////////////////////////////////////////////////////
+//  PriorBlock.hh
+//  Implementation of the Class PriorBlock
+///////////////////////////////////////////////////////////
+
+#if !defined(PB_5C1E9A37_84D2_4F6B_A0C3_7E2D19B8F465__INCLUDED_)
+#define PB_5C1E9A37_84D2_4F6B_A0C3_7E2D19B8F465__INCLUDED_
+
+#include <cassert>
+#include <limits>
+#include <vector>
+
+#include "EstimatedParameter.hh"
+#include "Prior.hh"
+
+/**
+ * Evaluates the log prior density of all estimated parameters at once.
+ *
+ * The parameters are grouped by distribution family, and each family is stored
+ * as a structure of arrays holding the bounds, the shape coefficients and the
+ * log normalizing constant of its members, all precomputed at construction.
+ * The log density of a family is then a plain loop over closed-form
+ * expressions, without virtual calls, and without the underflow of
+ * log(pdf(x)) in the tails of the distributions.
+ *
+ * The densities are the same as those of the Prior classes (in particular,
+ * the beta density rescaled to [lower_bound, upper_bound] has no Jacobian
+ * term).
+ */
+class PriorBlock
+{
+public:
+  PriorBlock(const std::vector<EstimatedParameter> &estParams);
+  virtual ~PriorBlock()
+  {
+  };
+
+  size_t
+  getSize() const
+  {
+    return size;
+  };
+
+  //! Returns the log prior density of ep, or -infinity outside of the support
+  template<class VEC>
+  double
+  compute(const VEC &ep)
+  {
+    assert(ep.getSize() == size);
+    double logPriorDensity = 0;
+    bool outside = false;
+    for (size_t f = 0; f < families.size(); f++)
+      {
+        Family &family = families[f];
+        for (size_t k = 0; k < family.index.size(); k++)
+          family.x[k] = ep(family.index[k]);
+        logPriorDensity += evalFamily(family, outside);
+      }
+    return outside ? -std::numeric_limits<double>::infinity() : logPriorDensity;
+  };
+
+private:
+  /**
+   * Members of a family; the meaning of the coefficients depends on its shape:
+   * - Beta: c1 = a-1, c2 = b-1, c3 = 1/(upper_bound-lower_bound) (lb = 0 and c3 = 1 for the standard beta)
+   * - Gamma: c1 = k-1, c2 = 1/theta
+   * - Inv_gamma_1: c1 = -(nu+1), c2 = s/2
+   * - Inv_gamma_2: c1 = -(nu/2+1), c2 = s/2
+   * - Gaussian: c1 = mean, c2 = 1/standard deviation
+   * - Uniform: c1, c2 = bounds of the uniform distribution
+   */
+  struct Family
+  {
+    Prior::pShape shape;
+    std::vector<size_t> index;
+    std::vector<double> x, lb, ub, c1, c2, c3, logConst;
+  };
+  std::vector<Family> families;
+  size_t size;
+
+  static double evalFamily(Family &family, bool &outside);
+};
+
+#endif // !defined(PB_5C1E9A37_84D2_4F6B_A0C3_7E2D19B8F465__INCLUDED_)
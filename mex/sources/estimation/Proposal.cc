@@ -28,17 +28,21 @@
 Proposal::Proposal(const VectorConstView &vJscale, const MatrixConstView &covariance) :
   len(covariance.getCols()),
   covarianceCholeskyDecomposition(len),
-  newDraw(len),
-  uniform_rng_type(0, 1), // uniform random number generator distribution type
-  uniformVrng(base_rng, uniform_rng_type), // uniform random variate_generator
-  normal_rng_type(0, 1), // normal random number generator distribution type (mean, standard)
-  normalVrng(base_rng, normal_rng_type) // normal random variate_generator
+  innovations(len, bufferSize), uniforms(bufferSize),
+  innovationsStart(0), uniformsStart(0), innovationsValid(false), uniformsValid(false),
+  drawStream(0, drawStreamID),
+  selectionTestStream(0, selectionTestStreamID),
+  curSeed(0), chain(0), drawIndex(0), selectionTestIndex(0)
 {
   Matrix Jscale(len);
   Matrix DD(len);
   DD = covariance;
 
   lapack::choleskyDecomp(DD, "U");
+  // dpotrf leaves the strictly lower triangle untouched
+  for (size_t j = 0; j < len; j++)
+    for (size_t i = j+1; i < len; i++)
+      DD(i, j) = 0.0;
   Jscale.setAll(0.0);
   for (size_t i = 0; i < len; i++)
     Jscale(i, i) = vJscale(i);
@@ -51,16 +55,53 @@ Proposal::draw(Vector &mean, Vector &draw)
   assert(len == draw.getSize());
   assert(len == mean.getSize());
 
+  if (!innovationsValid || drawIndex < innovationsStart || drawIndex >= innovationsStart + bufferSize)
+    fillInnovations(drawIndex);
+
   draw = mean;
-  for (size_t i = 0; i < len; ++i)
-    newDraw(i) =  normalVrng();
-  blas::gemv("T", 1.0, covarianceCholeskyDecomposition, newDraw, 1.0, draw);
+  vec::add(draw, mat::get_col(innovations, (size_t) (drawIndex - innovationsStart)));
+  drawIndex++;
+}
+
+void
+Proposal::fillInnovations(uint64_t start)
+{
+  for (size_t k = 0; k < bufferSize; k++)
+    drawStream.fillNormals(chain, start + k, innovations.getData() + k*innovations.getLd(), len);
+  // One triangular product for the whole batch, instead of a gemv per draw
+  blas::trmm("L", "U", "T", "N", 1.0, covarianceCholeskyDecomposition, innovations);
+  innovationsStart = start;
+  innovationsValid = true;
+}
+
+void
+Proposal::fillUniforms(uint64_t start)
+{
+  for (size_t k = 0; k < bufferSize; k++)
+    {
+      double unused;
+      selectionTestStream.uniforms(chain, start + k, 0, uniforms(k), unused);
+    }
+  uniformsStart = start;
+  uniformsValid = true;
+}
 
+void
+Proposal::rescale(const Vector &scale)
+{
+  assert(len == scale.getSize());
+  // The draws are mean + C'*z, hence the columns of C are scaled
+  for (size_t j = 0; j < len; ++j)
+    for (size_t i = 0; i < len; ++i)
+      covarianceCholeskyDecomposition(i, j) *= scale(j);
+  innovationsValid = false;
 }
 
 Matrix &
 Proposal::getVar()
 {
+  // The factor may be modified by the caller
+  innovationsValid = false;
   return covarianceCholeskyDecomposition;
 }
 
@@ -77,7 +118,26 @@ void
 Proposal::seed(int newSeed)
 {
   curSeed = newSeed;
-  base_rng.seed(curSeed);
+  drawStream = PhiloxStream((uint32_t) curSeed, drawStreamID);
+  selectionTestStream = PhiloxStream((uint32_t) curSeed, selectionTestStreamID);
+  innovationsValid = false;
+  uniformsValid = false;
+  setPosition(0);
+}
+
+void
+Proposal::setChain(size_t newChain)
+{
+  chain = (uint32_t) newChain;
+  innovationsValid = false;
+  uniformsValid = false;
+}
+
+void
+Proposal::setPosition(uint64_t position)
+{
+  drawIndex = position;
+  selectionTestIndex = position;
 }
 
 /**
@@ -86,5 +146,7 @@ Proposal::seed(int newSeed)
 double
 Proposal::selectionTestDraw()
 {
-  return uniformVrng();
+  if (!uniformsValid || selectionTestIndex < uniformsStart || selectionTestIndex >= uniformsStart + bufferSize)
+    fillUniforms(selectionTestIndex);
+  return uniforms((size_t) (selectionTestIndex++ - uniformsStart));
 }
@@ -28,7 +28,7 @@
 
 /**
  * Proposal class will then have the common, seed initialised base generator
- * (currently congruental rand48) and member functions such as seed, reset (to
+ * (a counter-based Philox generator, see philox.hh) and member functions such as seed, reset (to
  * initial,default value) and have all rand generators we need that generate from
  * that common base: single uniform and normal (either single or multivariate
  * determined by  the size of the variance matrix)  for now.
@@ -40,20 +40,16 @@
  * matrix) , as core members  .This class will handle the main boost random rng
  * intricacies. See enclosed updated diagram (if ok I will upload it)
  *
+ * The numbers of the n-th call to draw() and selectionTestDraw() only depend
+ * on the seed, the chain and n, so that any draw of any chain can be
+ * reproduced with setChain() and setPosition(). Since they do not depend on
+ * the order of the calls, they are generated in batches ahead of time.
  */
 
 #include "Matrix.hh"
 #include "BlasBindings.hh"
 #include "LapackBindings.hh"
-#include <boost/random/linear_congruential.hpp>
-#include <boost/random/normal_distribution.hpp>
-#include <boost/random/uniform_real.hpp>
-#include <boost/random/variate_generator.hpp>
-
-// typedef for base_uniform_generator_type
-// rend48 seems better than the basic minstd_rand  but
-// one my later try ecuyer1988 or taus88 which are better but not yet supported in the Boost versionwe use
-typedef boost::rand48 base_uniform_generator_type;
+#include "philox.hh"
 
 class Proposal
 {
@@ -66,28 +62,64 @@ public:
   virtual ~Proposal()
   {
   };
+  //! Copy of the proposal, including the state of its streams, e.g. for running another chain
+  virtual Proposal *
+  clone() const
+  {
+    return new Proposal(*this);
+  };
   virtual void draw(Vector &mean, Vector &draw);
   virtual Matrix&getVar();
   virtual int seed();
   virtual void seed(int seedInit);
   virtual double selectionTestDraw();
+  //! Multiplies the i-th component of the draws by scale(i), e.g. to move the proposal to a transformed space
+  virtual void rescale(const Vector &scale);
+  //! Selects the chain, i.e. the independent stream of numbers to use
+  virtual void setChain(size_t chain);
+  size_t
+  getChain() const
+  {
+    return chain;
+  };
+  //! Sets the number of draws already made, i.e. the index of the next draw
+  virtual void setPosition(uint64_t position);
+  uint64_t
+  getPosition() const
+  {
+    return drawIndex;
+  };
+  //! Called by the sampler after each selection test, with the current state of the chain; the base proposal is fixed
+  virtual void
+  adapt(const Vector &state, bool accepted)
+  {
+  };
 
-private:
+protected:
   size_t len;
+  //! Upper triangular factor C, such that the draws are mean + C'*z
   Matrix covarianceCholeskyDecomposition;
+
   /**
-   * Vector of new draws
-   *
+   * The innovations C'*z and the uniform numbers of the next bufferSize draws
+   * are generated ahead of time, in batches, starting from the given indices;
+   * a buffer is refilled when a draw outside of it is requested.
    */
-  Vector newDraw;
+  static const size_t bufferSize = 64;
+  Matrix innovations;
+  Vector uniforms;
+  uint64_t innovationsStart, uniformsStart;
+  bool innovationsValid, uniformsValid;
+  void fillInnovations(uint64_t start);
+  void fillUniforms(uint64_t start);
 
-  base_uniform_generator_type base_rng;
-  boost::uniform_real<> uniform_rng_type;
-  boost::variate_generator<base_uniform_generator_type &,  boost::uniform_real<> > uniformVrng;
-  boost::normal_distribution<double> normal_rng_type;
-  boost::variate_generator<base_uniform_generator_type &, boost::normal_distribution<double> > normalVrng;
+  //! Streams of the normal numbers of the draws, and of the uniform numbers of the selection tests
+  enum { drawStreamID = 0, selectionTestStreamID = 1 };
+  PhiloxStream drawStream, selectionTestStream;
 
   int curSeed;
+  uint32_t chain;
+  uint64_t drawIndex, selectionTestIndex;
 
 };
 
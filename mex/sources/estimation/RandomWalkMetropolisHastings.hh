@@ -26,52 +26,112 @@
 #if !defined(A6BBC5E0_598E_4863_B7FF_E87320056B80__INCLUDED_)
 #define A6BBC5E0_598E_4863_B7FF_E87320056B80__INCLUDED_
 
-#include <iostream>
-#include <fstream>
 #include "LogPosteriorDensity.hh"
 #include "Proposal.hh"
+#include "ParameterTransform.hh"
+#include "MHTraceSink.hh"
 
 class RandomWalkMetropolisHastings
 {
 
 private:
+  //! Current and proposed draws, in the space where the random walk takes place
   Vector parDraw, newParDraw;
+  //! Same draws in the space of the estimated parameters
+  Vector parValues, newParValues;
+  const ParameterTransform *transform;
+  MHTraceSink *traceSink;
 
 public:
   RandomWalkMetropolisHastings(size_t size) :
-    parDraw(size), newParDraw(size)
+    parDraw(size), newParDraw(size), parValues(size), newParValues(size), transform(NULL), traceSink(NULL)
   {
   };
   virtual ~RandomWalkMetropolisHastings()
   {
   };
 
+  /**
+   * Makes the random walk take place in the unconstrained space of the
+   * transform (or in the space of the estimated parameters if NULL). The
+   * proposal must then be expressed in that space; the draws and the log
+   * posterior densities which are returned are those of the estimated
+   * parameters.
+   */
+  void
+  setTransform(const ParameterTransform *transform_arg)
+  {
+    transform = transform_arg;
+  };
+
+  //! Sends a trace of all proposals to the sink (none if NULL, the default)
+  void
+  setTraceSink(MHTraceSink *traceSink_arg)
+  {
+    traceSink = traceSink_arg;
+  };
+
+  /**
+   * Position of the proposal stream of a chain whose MH files are resumed at
+   * line fline of file newFile (both counted from 1), i.e. the number of draws
+   * in the earlier files, of maxDrawsPerFile draws each, and in the current
+   * one. If an earlier file is shorter, the position is past the draws
+   * already made, so that the chain never reuses their numbers.
+   */
+  static uint64_t
+  resumePosition(size_t newFile, size_t fline, size_t maxDrawsPerFile)
+  {
+    return (uint64_t) (newFile-1)*maxDrawsPerFile + fline-1;
+  };
+
+  /**
+   * Runs the chain from estParams over the draws [startDraw-1, nMHruns) of
+   * mhParams and mhLogPostDens, and returns the acceptance rate.
+   *
+   * currentLogPost is the log posterior density at estParams if it is known
+   * (typically, the last one recorded by the previous call), or NaN, in which
+   * case it is computed; on exit, it is the log posterior density at the last
+   * draw, to be passed to the next call which continues the chain.
+   */
   template<class VEC1>
   double
   compute(VectorView &mhLogPostDens, MatrixView &mhParams, VEC1 &steadyState,
-          Vector &estParams, VectorView &deepParams, const MatrixConstView &data, MatrixView &Q, Matrix &H,
-          const size_t presampleStart, const size_t startDraw, size_t nMHruns,
+          Vector &estParams, double &currentLogPost, VectorView &deepParams, const MatrixConstView &data,
+          MatrixView &Q, Matrix &H, const size_t presampleStart, const size_t startDraw, size_t nMHruns,
           LogPosteriorDensity &lpd, Proposal &pDD, EstimatedParametersDescription &epd)
   {
-    //streambuf *likbuf, *drawbuf *backup;
-    std::ofstream urandfilestr, drawfilestr;
-    urandfilestr.open("urand.csv");
-    drawfilestr.open("paramdraws.csv");
-
     bool overbound;
-    double newLogpost, logpost, urand;
+    double newLogpost, logpost, urand, newLogJacobian = 0, logJacobian = 0;
     size_t count, accepted = 0;
-    parDraw = estParams;
+    parValues = estParams;
+    if (transform)
+      {
+        transform->toUnconstrained(parValues, parDraw);
+        logJacobian = transform->logJacobian(parDraw);
+      }
+    else
+      parDraw = parValues;
 
-    logpost = -lpd.compute(steadyState, estParams, deepParams, data, Q, H, presampleStart);
+    if (std::isnan(currentLogPost))
+      logpost = -lpd.compute(steadyState, estParams, deepParams, data, Q, H, presampleStart);
+    else
+      logpost = currentLogPost;
 
     for (size_t run = startDraw - 1; run < nMHruns; ++run)
       {
         overbound = false;
         pDD.draw(parDraw, newParDraw);
+        if (transform)
+          {
+            transform->toConstrained(newParDraw, newParValues);
+            newLogJacobian = transform->logJacobian(newParDraw);
+          }
+        else
+          newParValues = newParDraw;
+        // With a transform, this only catches the draws which are rounded to a bound
         for (count = 0; count < parDraw.getSize(); ++count)
           {
-            overbound = (newParDraw(count) < epd.estParams[count].lower_bound || newParDraw(count) > epd.estParams[count].upper_bound);
+            overbound = (newParValues(count) < epd.estParams[count].lower_bound || newParValues(count) > epd.estParams[count].upper_bound);
             if (overbound)
               {
                 newLogpost = -INFINITY;
@@ -82,7 +142,7 @@ public:
           {
             try
               {
-                newLogpost = -lpd.compute(steadyState, newParDraw, deepParams, data, Q, H, presampleStart);
+                newLogpost = -lpd.compute(steadyState, newParValues, deepParams, data, Q, H, presampleStart);
               }
             catch (const std::exception &e)
               {
@@ -94,23 +154,25 @@ public:
               }
           }
         urand = pDD.selectionTestDraw();
-        if ((newLogpost > -INFINITY) && log(urand) < newLogpost-logpost)
+        bool accept = (newLogpost > -INFINITY) && log(urand) < newLogpost+newLogJacobian-logpost-logJacobian;
+        if (accept)
           {
             parDraw = newParDraw;
+            parValues = newParValues;
             logpost = newLogpost;
+            logJacobian = newLogJacobian;
             accepted++;
           }
-        mat::get_row(mhParams, run) = parDraw;
+        pDD.adapt(parDraw, accept);
+        mat::get_row(mhParams, run) = parValues;
         mhLogPostDens(run) = logpost;
 
-        urandfilestr << urand << "\n"; //","
-        for (size_t c = 0; c < newParDraw.getSize()-1; ++c)
-          drawfilestr << newParDraw(c) << ",";
-        drawfilestr <<  newParDraw(newParDraw.getSize()-1) << "\n";
+        if (traceSink)
+          traceSink->record(pDD.getChain(), pDD.getPosition()-1, urand, newLogpost, accept, newParValues);
       }
-
-    urandfilestr.close();
-    drawfilestr.close();
+    if (traceSink)
+      traceSink->flush();
+    currentLogPost = logpost;
 
     return (double) accepted/(nMHruns-startDraw+1);
   };
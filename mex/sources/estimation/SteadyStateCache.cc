@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+///////////////////////////////////////////////////////////
+//  SteadyStateCache.cc
+//  Implementation of the Class SteadyStateCache
+///////////////////////////////////////////////////////////
+
+#include "SteadyStateCache.hh"
+
+const double SteadyStateCache::minScale = 1e-3;
+
+SteadyStateCache::SteadyStateCache(size_t n_params_arg, size_t n_endo_arg, size_t capacity_arg) :
+  n_params(n_params_arg), n_endo(n_endo_arg), capacity(capacity_arg),
+  params(n_params, capacity), steadyStates(n_endo, capacity), size(0), next(0)
+{
+}
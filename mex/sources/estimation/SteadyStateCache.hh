@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+///////////////////////////////////////////////////////////
+//  SteadyStateCache.hh
+//  Implementation of the Class SteadyStateCache
+///////////////////////////////////////////////////////////
+
+#if !defined(SSC_2B9E7D14_6A3F_4C81_9D5E_F3A8C1B04726__INCLUDED_)
+#define SSC_2B9E7D14_6A3F_4C81_9D5E_F3A8C1B04726__INCLUDED_
+
+#include <cmath>
+
+#include "Vector.hh"
+#include "Matrix.hh"
+
+/**
+ * Bounded cache of recently computed steady states, indexed by the deep
+ * parameters, used to warm-start the steady state solver from the solution
+ * of the nearest parameter vector.
+ *
+ * Entries are stored by columns in preallocated matrices, and the oldest
+ * entry is replaced when the cache is full. Since the cache is small, the
+ * nearest neighbour is found by a scan of the parameter matrix, which is
+ * contiguous in memory; the distance is computed relatively to the magnitude
+ * of each parameter, so that it does not depend on their units.
+ */
+class SteadyStateCache
+{
+public:
+  SteadyStateCache(size_t n_params_arg, size_t n_endo_arg, size_t capacity_arg);
+  virtual ~SteadyStateCache()
+  {
+  };
+
+  size_t
+  getSize() const
+  {
+    return size;
+  };
+
+  void
+  clear()
+  {
+    size = 0;
+    next = 0;
+  };
+
+  //! Index of the entry whose parameters are the nearest to deepParams (the cache must not be empty)
+  template<class Vec>
+  size_t
+  nearest(const Vec &deepParams) const
+  {
+    assert(deepParams.getSize() == n_params && size > 0);
+    size_t best = 0;
+    double bestDistance = 0;
+    for (size_t k = 0; k < size; k++)
+      {
+        double distance = 0;
+        for (size_t i = 0; i < n_params; i++)
+          {
+            double scale = fabs(deepParams(i)) > minScale ? fabs(deepParams(i)) : minScale;
+            double d = (params(i, k) - deepParams(i)) / scale;
+            distance += d*d;
+          }
+        if (k == 0 || distance < bestDistance)
+          {
+            best = k;
+            bestDistance = distance;
+          }
+      }
+    return best;
+  };
+
+  /**
+   * Looks for the entry whose parameters are the nearest to deepParams.
+   * \return false if the cache is empty; otherwise the steady state of this entry is copied into steadyState
+   */
+  template<class Vec1, class Vec2>
+  bool
+  findNearest(const Vec1 &deepParams, Vec2 &steadyState) const
+  {
+    assert(steadyState.getSize() == n_endo);
+    if (size == 0)
+      return false;
+    steadyState = mat::get_col(steadyStates, nearest(deepParams));
+    return true;
+  };
+
+  VectorConstView
+  getParams(size_t k) const
+  {
+    assert(k < size);
+    return mat::get_col(params, k);
+  };
+
+  VectorConstView
+  getSteadyState(size_t k) const
+  {
+    assert(k < size);
+    return mat::get_col(steadyStates, k);
+  };
+
+  //! Records a steady state, replacing the oldest entry if the cache is full
+  template<class Vec1, class Vec2>
+  void
+  insert(const Vec1 &deepParams, const Vec2 &steadyState)
+  {
+    assert(deepParams.getSize() == n_params && steadyState.getSize() == n_endo);
+    if (capacity == 0)
+      return;
+    VectorView p = mat::get_col(params, next), s = mat::get_col(steadyStates, next);
+    p = deepParams;
+    s = steadyState;
+    next = (next + 1) % capacity;
+    if (size < capacity)
+      size++;
+  };
+
+private:
+  const size_t n_params, n_endo, capacity;
+  //! Parameters below this magnitude are compared in absolute terms
+  static const double minScale;
+  Matrix params, steadyStates;
+  size_t size, next;
+};
+
+#endif // !defined(SSC_2B9E7D14_6A3F_4C81_9D5E_F3A8C1B04726__INCLUDED_)
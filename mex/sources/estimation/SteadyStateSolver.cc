@@ -17,64 +17,315 @@
  * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cmath>
+
 #include "SteadyStateSolver.hh"
 
 const double SteadyStateSolver::tolerance = 1e-7;
 
 SteadyStateSolver::SteadyStateSolver(const std::string &basename, size_t n_endo_arg)
-  : static_dll(basename), n_endo(n_endo_arg), residual(n_endo), g1(n_endo)
+  : static_dll(basename), steady_state_dll(basename), checkAnalyticSteadyState(false), n_endo(n_endo_arg), residual(n_endo),
+  system(static_dll), solver(n_endo, tolerance, max_iterations),
+  blocksAnalyzed(false), useBlocks(false), yBlocks(n_endo), FBlocks(n_endo), xBlock(n_endo), g1(n_endo),
+  blockSystem(system, yBlocks, FBlocks, g1), passJacobian(n_endo), cache(NULL), cacheCapacity(default_cache_capacity), yStart(n_endo),
+  recoveryStarts(0), lastRecoveryStart(-1), recoveryPool(NULL), recoveryResults(NULL)
+{
+}
+
+SteadyStateSolver::~SteadyStateSolver()
+{
+  for (std::map<size_t, NewtonSolver *>::iterator it = blockSolvers.begin(); it != blockSolvers.end(); ++it)
+    delete it->second;
+  delete cache;
+  for (size_t i = 0; i < recoverySlots.size(); i++)
+    delete recoverySlots[i];
+  delete recoveryPool;
+  delete recoveryResults;
+}
+
+bool
+SteadyStateSolver::solveFromStart()
+{
+  yBlocks = yStart;
+  if (!blocksAnalyzed)
+    analyzeBlocks();
+
+  // Small simultaneous blocks are solved instead of the whole model, when possible
+  if (useBlocks && solveByBlocks())
+    {
+      yStart = yBlocks;
+      return true;
+    }
+
+  return solver.solve(system, yStart);
+}
+
+void
+SteadyStateSolver::StaticSystem::residuals(const Vector &y, Vector &F)
 {
-  g1.setAll(0.0); // The static file does not initialize zero elements
+  VectorConstView params(deepParams, n_params, 1);
+  MatrixConstView Mx(x, 1, n_exo, 1);
+
+  static_dll.eval(y, Mx, params, F, NULL, NULL);
+}
+
+void
+SteadyStateSolver::StaticSystem::jacobian(const Vector &y, Vector &F, Matrix &J)
+{
+  VectorConstView params(deepParams, n_params, 1);
+  MatrixConstView Mx(x, 1, n_exo, 1);
+
+  J.setAll(0.0); // The static file does not initialize zero elements
+  static_dll.eval(y, Mx, params, F, &J, NULL);
+}
+
+void
+SteadyStateSolver::BlockSystem::residuals(const Vector &yb, Vector &Fb)
+{
+  for (size_t i = 0; i < variables->size(); i++)
+    y((*variables)[i]) = yb(i);
+  staticSystem.residuals(y, F);
+  for (size_t i = 0; i < equations->size(); i++)
+    Fb(i) = F((*equations)[i]);
+}
+
+void
+SteadyStateSolver::BlockSystem::jacobian(const Vector &yb, Vector &Fb, Matrix &Jb)
+{
+  for (size_t i = 0; i < variables->size(); i++)
+    y((*variables)[i]) = yb(i);
+  staticSystem.jacobian(y, F, J);
+  for (size_t i = 0; i < equations->size(); i++)
+    {
+      Fb(i) = F((*equations)[i]);
+      for (size_t j = 0; j < variables->size(); j++)
+        Jb(i, j) = J((*equations)[i], (*variables)[j]);
+    }
 }
 
-int
-SteadyStateSolver::static_f(const gsl_vector *yy, void *p, gsl_vector *F)
+void
+SteadyStateSolver::analyzeBlocks()
 {
-  params *pp = (params *) p;
-  VectorConstView deepParams(pp->deepParams, pp->n_params, 1);
-  MatrixConstView x(pp->x, 1, pp->n_exo, 1);
+  blocksAnalyzed = true;
 
-  VectorView y(yy->data, yy->size, yy->stride);
-  VectorView residual(F->data, F->size, F->stride);
+  // The sparsity pattern is the union of the nonzero entries of the jacobian at two points, so
+  // that entries which vanish by accident at one of them are not missed
+  Matrix pattern(n_endo);
+  system.jacobian(yBlocks, FBlocks, g1);
+  pattern = g1;
+  for (size_t i = 0; i < n_endo; i++)
+    xBlock(i) = yBlocks(i)*(1 + 1e-2*(1 + i % 7)) + 1e-3*(1 + i % 5);
+  system.jacobian(xBlock, FBlocks, g1);
+  for (size_t j = 0; j < n_endo; j++)
+    for (size_t i = 0; i < n_endo; i++)
+      pattern(i, j) = fabs(pattern(i, j)) + fabs(g1(i, j));
 
-  pp->static_dll->eval(y, x, deepParams, residual, NULL, NULL);
+  // A single block is better handled by the solver of the whole model
+  useBlocks = blocks.compute(pattern) && blocks.getNumBlocks() > 1;
+  if (!useBlocks)
+    return;
 
-  return GSL_SUCCESS;
+  // The tolerance of each block is proportional to its size, so that the whole model meets the global one
+  for (size_t b = 0; b < blocks.getNumBlocks(); b++)
+    {
+      size_t size = blocks.getEquations(b).size();
+      if (blockSolvers.find(size) == blockSolvers.end())
+        blockSolvers[size] = new NewtonSolver(size, tolerance*size/n_endo, max_iterations);
+    }
 }
 
-int
-SteadyStateSolver::static_df(const gsl_vector *yy, void *p, gsl_matrix *J)
+bool
+SteadyStateSolver::solveByBlocks()
 {
-  params *pp = (params *) p;
-  VectorConstView deepParams(pp->deepParams, pp->n_params, 1);
-  MatrixConstView x(pp->x, 1, pp->n_exo, 1);
+  // The static DLL evaluates all the equations at once: a single jacobian is computed for the whole pass,
+  // and the residuals are reused from one block to the next as long as they are those at yBlocks
+  system.jacobian(yBlocks, FBlocks, passJacobian);
+  bool residualsCurrent = true;
 
-  VectorView y(yy->data, yy->size, yy->stride);
+  for (size_t b = 0; b < blocks.getNumBlocks(); b++)
+    {
+      blockSystem.equations = &blocks.getEquations(b);
+      blockSystem.variables = &blocks.getVariables(b);
+      size_t size = blockSystem.variables->size();
 
-  pp->static_dll->eval(y, x, deepParams, *pp->residual, pp->g1, NULL);
+      // Prologue and epilogue equations (and other recursive ones) are solved directly
+      if (size == 1)
+        {
+          if (!residualsCurrent)
+            system.residuals(yBlocks, FBlocks);
+          residualsCurrent = true;
+          if (solveSingleEquation((*blockSystem.equations)[0], (*blockSystem.variables)[0]))
+            continue;
+        }
 
-  assert(J->size1 == J->size2 && J->size1 == J->tda);
-  MatrixView g1t(J->data, J->size1, J->size2, J->tda);
-  mat::transpose(g1t, *pp->g1); // GSL wants row-major order
+      VectorView x(xBlock, 0, size);
+      for (size_t i = 0; i < size; i++)
+        x(i) = yBlocks((*blockSystem.variables)[i]);
+      if (!blockSolvers[size]->solve(blockSystem, x))
+        return false;
+      for (size_t i = 0; i < size; i++)
+        yBlocks((*blockSystem.variables)[i]) = x(i);
+      residualsCurrent = false;
+    }
 
-  return GSL_SUCCESS;
+  // Safety net, in case the sparsity pattern missed a dependency
+  if (!residualsCurrent)
+    system.residuals(yBlocks, FBlocks);
+  double sum = 0;
+  for (size_t i = 0; i < n_endo; i++)
+    sum += fabs(FBlocks(i));
+  return sum < tolerance;
 }
 
-int
-SteadyStateSolver::static_fdf(const gsl_vector *yy, void *p, gsl_vector *F, gsl_matrix *J)
+bool
+SteadyStateSolver::solveSingleEquation(size_t equation, size_t variable)
 {
-  params *pp = (params *) p;
-  VectorConstView deepParams(pp->deepParams, pp->n_params, 1);
-  MatrixConstView x(pp->x, 1, pp->n_exo, 1);
+  double tol = tolerance/n_endo; // As for the NewtonSolver of the blocks of size 1
+  double x = yBlocks(variable), f = FBlocks(equation);
+  if (fabs(f) < tol)
+    return true;
+
+  double x0 = x, slope = passJacobian(equation, variable);
+  for (size_t iter = 0; iter < max_secant_iterations; iter++)
+    {
+      if (!(slope != 0 && std::isfinite(slope)))
+        break;
+      double xNew = x - f/slope;
+      yBlocks(variable) = xNew;
+      system.residuals(yBlocks, FBlocks);
+      double fNew = FBlocks(equation);
+      if (fabs(fNew) < tol)
+        return true;
+      // Leave the hard cases to the trust-region solver
+      if (!(fabs(fNew) < fabs(f)))
+        break;
+      slope = (fNew - f)/(xNew - x);
+      x = xNew;
+      f = fNew;
+    }
 
-  VectorView y(yy->data, yy->size, yy->stride);
-  VectorView residual(F->data, F->size, F->stride);
+  yBlocks(variable) = x0;
+  return false;
+}
+
+SteadyStateSolver::RecoverySlot::RecoverySlot(StaticModelDLL &static_dll, size_t n_endo, size_t n_params) :
+  system(static_dll), solver(n_endo, tolerance, max_iterations), y(n_endo), params(n_params)
+{
+}
+
+void
+SteadyStateSolver::setRecovery(size_t nStarts, size_t nThreads) throw (TSException)
+{
+  for (size_t i = 0; i < recoverySlots.size(); i++)
+    delete recoverySlots[i];
+  recoverySlots.clear();
+  delete recoveryPool;
+  recoveryPool = NULL;
+  delete recoveryResults;
+  recoveryResults = NULL;
+
+  recoveryStarts = nStarts;
+  if (nStarts == 0)
+    return;
+  recoveryPool = new ThreadPool(nThreads);
+  recoveryResults = new Matrix(n_endo, nStarts);
+}
+
+SteadyStateSolver::RecoveryTask::RecoveryTask(SteadyStateSolver &solver_arg, const double *deepParams_arg, long homotopyOrigin_arg) :
+  solver(solver_arg), deepParams(deepParams_arg), homotopyOrigin(homotopyOrigin_arg), firstSuccess(solver_arg.recoveryStarts)
+{
+  pthread_mutex_init(&mutex, NULL);
+}
+
+SteadyStateSolver::RecoveryTask::~RecoveryTask()
+{
+  pthread_mutex_destroy(&mutex);
+}
+
+void
+SteadyStateSolver::RecoveryTask::run(size_t item, size_t worker)
+{
+  // Restarts with a higher index than a successful one are useless
+  pthread_mutex_lock(&mutex);
+  bool skip = item > firstSuccess;
+  pthread_mutex_unlock(&mutex);
+  if (skip)
+    return;
+
+  RecoverySlot &slot = *solver.recoverySlots[worker];
+  size_t n_endo = solver.n_endo, n_params = slot.params.getSize();
+  bool success = true;
+
+  if (item % 2 == 1 && homotopyOrigin >= 0)
+    {
+      // Move the parameters gradually from those of the cached solution
+      VectorConstView origin = solver.cache->getParams(homotopyOrigin);
+      slot.y = solver.cache->getSteadyState(homotopyOrigin);
+      slot.system.deepParams = slot.params.getData();
+      size_t nSteps = 4 << (item / 2);
+      for (size_t step = 1; step <= nSteps && success; step++)
+        {
+          double t = (double) step / nSteps;
+          for (size_t i = 0; i < n_params; i++)
+            slot.params(i) = origin(i) + t*(deepParams[i] - origin(i));
+          success = slot.solver.solve(slot.system, slot.y);
+        }
+    }
+  else
+    {
+      // Perturb the guess, with a deterministic pseudo-random sequence
+      double amplitude = 0.1*(1 + item / 2);
+      unsigned long state = 2654435761UL*(item + 1);
+      for (size_t i = 0; i < n_endo; i++)
+        {
+          state = (1103515245UL*state + 12345UL) % 2147483648UL;
+          double u = 2.0*state/2147483648.0 - 1;
+          slot.y(i) = solver.yStart(i)*(1 + amplitude*u) + 0.1*amplitude*u;
+        }
+      slot.system.deepParams = deepParams;
+      success = slot.solver.solve(slot.system, slot.y);
+    }
+
+  if (!success)
+    return;
+
+  VectorView result = mat::get_col(*solver.recoveryResults, item);
+  result = slot.y;
+  pthread_mutex_lock(&mutex);
+  if (item < firstSuccess)
+    firstSuccess = item;
+  pthread_mutex_unlock(&mutex);
+}
+
+bool
+SteadyStateSolver::recover()
+{
+  if (recoverySlots.empty())
+    for (size_t i = 0; i < recoveryPool->getNumWorkers(); i++)
+      recoverySlots.push_back(new RecoverySlot(static_dll, n_endo, system.n_params));
 
-  pp->static_dll->eval(y, x, deepParams, residual, pp->g1, NULL);
+  for (size_t i = 0; i < recoverySlots.size(); i++)
+    {
+      StaticSystem &s = recoverySlots[i]->system;
+      s.n_params = system.n_params;
+      s.x = system.x;
+      s.n_exo = system.n_exo;
+    }
 
-  assert(J->size1 == J->size2 && J->size1 == J->tda);
-  MatrixView g1t(J->data, J->size1, J->size2, J->tda);
-  mat::transpose(g1t, *pp->g1); // GSL wants row-major order
+  long homotopyOrigin = cache != NULL && cache->getSize() > 0 ? (long) cache->nearest(VectorConstView(system.deepParams, system.n_params, 1)) : -1;
+  RecoveryTask task(*this, system.deepParams, homotopyOrigin);
+  try
+    {
+      recoveryPool->run(task, recoveryStarts);
+    }
+  catch (TSException &e)
+    {
+      return false;
+    }
 
-  return GSL_SUCCESS;
+  if (task.firstSuccess == recoveryStarts)
+    return false;
+  yStart = mat::get_col(*recoveryResults, task.firstSuccess);
+  lastRecoveryStart = (long) task.firstSuccess;
+  return true;
 }
@@ -18,39 +18,128 @@
  */
 
 #include <string>
+#include <map>
 
 #include "Vector.hh"
+#include "NewtonSolver.hh"
+#include "BlockDecomposition.hh"
+#include "SteadyStateCache.hh"
+#include "thread_pool.hh"
 #include "static_dll.hh"
-
-#include <gsl/gsl_vector.h>
-#include <gsl/gsl_multiroots.h>
+#include "steady_state_dll.hh"
 
 class SteadyStateSolver
 {
 private:
   StaticModelDLL static_dll;
+  SteadyStateModelDLL steady_state_dll; // Closed form of the steady state, if the model provides one
+  bool checkAnalyticSteadyState;
   size_t n_endo;
-  Vector residual; // Will be discarded, only used by df()
-  Matrix g1; // Temporary buffer for computing transpose
+  Vector residual; // Used by the check of the closed form
 
-  struct params
+  //! The static model, seen as a nonlinear system in the endogenous variables
+  class StaticSystem : public NewtonSolver::System
   {
-    StaticModelDLL *static_dll;
+  public:
+    StaticModelDLL &static_dll;
     const double *deepParams;
     size_t n_params;
     const double *x;
     size_t n_exo;
-    Vector *residual;
-    Matrix *g1;
+    StaticSystem(StaticModelDLL &static_dll_arg) : static_dll(static_dll_arg), deepParams(NULL), n_params(0), x(NULL), n_exo(0)
+    {
+    };
+    virtual void residuals(const Vector &y, Vector &F);
+    virtual void jacobian(const Vector &y, Vector &F, Matrix &J);
+  };
+  StaticSystem system;
+  NewtonSolver solver;
+
+  //! A block of the static model, seen as a system in the variables of this block
+  class BlockSystem : public NewtonSolver::System
+  {
+  public:
+    StaticSystem &staticSystem;
+    Vector &y; // All the endogenous variables, those of the previous blocks being already solved
+    Vector &F;
+    Matrix &J;
+    const std::vector<size_t> *equations, *variables;
+    BlockSystem(StaticSystem &staticSystem_arg, Vector &y_arg, Vector &F_arg, Matrix &J_arg) :
+      staticSystem(staticSystem_arg), y(y_arg), F(F_arg), J(J_arg), equations(NULL), variables(NULL)
+    {
+    };
+    virtual void residuals(const Vector &yb, Vector &Fb);
+    virtual void jacobian(const Vector &yb, Vector &Fb, Matrix &Jb);
   };
 
-  static int static_f(const gsl_vector *yy, void *p, gsl_vector *F);
-  static int static_df(const gsl_vector *yy, void *p, gsl_matrix *J);
-  static int static_fdf(const gsl_vector *yy, void *p, gsl_vector *F, gsl_matrix *J);
+  // Block decomposition of the static model, computed on the first call
+  BlockDecomposition blocks;
+  bool blocksAnalyzed, useBlocks;
+  std::map<size_t, NewtonSolver *> blockSolvers; // One per block size
+  Vector yBlocks, FBlocks, xBlock;
+  Matrix g1;
+  BlockSystem blockSystem;
+  //! Jacobian at the start of solveByBlocks(), giving the initial slopes of the single equation blocks
+  Matrix passJacobian;
+
+  //! Finds the blocks from the sparsity pattern of the jacobian around yBlocks
+  void analyzeBlocks();
+  //! Solves the blocks one after the other, starting from yBlocks
+  bool solveByBlocks();
+  /*!
+    Solves a block made of a single equation by the secant method, starting from the slope in passJacobian.
+    FBlocks must hold the residuals at yBlocks, and still does on success.
+    \return false if the iterations do not decrease the residual, in which case yBlocks is left unchanged (but not FBlocks)
+  */
+  bool solveSingleEquation(size_t equation, size_t variable);
+  const static size_t max_secant_iterations = 20;
+
+  // Warm start from the nearest parameters already solved, created on the first call
+  SteadyStateCache *cache;
+  size_t cacheCapacity;
+  Vector yStart;
+  //! Solves the static model starting from yStart, which receives the solution
+  bool solveFromStart();
+
+  // Recovery from failures, by several restarts run in parallel
+  struct RecoverySlot
+  {
+    StaticSystem system;
+    NewtonSolver solver;
+    Vector y, params;
+    RecoverySlot(StaticModelDLL &static_dll, size_t n_endo, size_t n_params);
+  };
+  class RecoveryTask : public ThreadPool::Task
+  {
+  public:
+    SteadyStateSolver &solver;
+    const double *deepParams;
+    //! Index of the nearest cached solution, used as the origin of homotopies (or -1 if there is none)
+    long homotopyOrigin;
+    //! Lowest index of a successful restart (or number of restarts if none)
+    size_t firstSuccess;
+    pthread_mutex_t mutex;
+    RecoveryTask(SteadyStateSolver &solver_arg, const double *deepParams_arg, long homotopyOrigin_arg);
+    virtual ~RecoveryTask();
+    virtual void run(size_t item, size_t worker);
+  };
+  size_t recoveryStarts;
+  long lastRecoveryStart;
+  ThreadPool *recoveryPool;
+  std::vector<RecoverySlot *> recoverySlots;
+  Matrix *recoveryResults; // Solution of each restart
+  //! Runs the restarts for the parameters of system, from the guess in yStart; the first successful one (by index) goes into yStart
+  bool recover();
+
+  // Not copyable
+  SteadyStateSolver(const SteadyStateSolver &);
+  SteadyStateSolver &operator=(const SteadyStateSolver &);
 
   const static double tolerance;
   const static size_t max_iterations = 1000;
 public:
+  const static size_t default_cache_capacity = 32;
+
   class SteadyStateException
   {
   public:
@@ -61,6 +150,48 @@ public:
   };
 
   SteadyStateSolver(const std::string &basename, size_t n_endo_arg);
+  virtual ~SteadyStateSolver();
+
+  //! Whether the model provides its steady state in closed form (see SteadyStateModelDLL)
+  bool
+  hasAnalyticSteadyState() const
+  {
+    return steady_state_dll.isAvailable();
+  }
+
+  //! Number of steady states kept for warm starts (0 disables the cache); a change drops the steady states already kept
+  void
+  setWarmStartCacheSize(size_t capacity)
+  {
+    if (capacity == cacheCapacity)
+      return;
+    delete cache;
+    cache = NULL;
+    cacheCapacity = capacity;
+  }
+
+  /**
+   * When the solver fails, the steady state is looked for again from nStarts other starting points, using nThreads threads:
+   * - even restarts start from the guess, randomly perturbed with increasing amplitudes;
+   * - odd restarts follow a homotopy in the deep parameters from the nearest cached solution, with more and more steps.
+   * The solution of the successful restart with the lowest index is kept, so that the result does not depend on thread scheduling.
+   * A value of 0 for nStarts disables the recovery (the default).
+   */
+  void setRecovery(size_t nStarts, size_t nThreads) throw (TSException);
+
+  //! Index of the restart which found the last steady state, or -1 if it was found without them
+  long
+  getLastRecoveryStart() const
+  {
+    return lastRecoveryStart;
+  }
+
+  //! If set, the closed form steady state is checked against the static model
+  void
+  setCheckAnalyticSteadyState(bool check)
+  {
+    checkAnalyticSteadyState = check;
+  }
 
   template <class Vec1, class Mat, class Vec2>
   void
@@ -72,39 +203,44 @@ public:
 
     assert(steadyState.getSize() == n_endo);
 
-    gsl_vector_view ss = gsl_vector_view_array(steadyState.getData(), n_endo);
-
-    params p = { &static_dll, deepParams.getData(), deepParams.getSize(), Mx.getData(), Mx.getCols(), &residual, &g1 };
-
-    gsl_multiroot_function_fdf f = {&static_f, &static_df, &static_fdf,
-                                    n_endo, &p};
-
-    const gsl_multiroot_fdfsolver_type *T = gsl_multiroot_fdfsolver_hybridsj;
-    gsl_multiroot_fdfsolver *s = gsl_multiroot_fdfsolver_alloc(T, n_endo);
-
-    gsl_multiroot_fdfsolver_set(s, &f, &ss.vector);
-
-    int status;
-    size_t iter = 0;
-
-    do
+    // The nonlinear solver is not needed when the steady state has a closed form
+    if (steady_state_dll.isAvailable())
       {
-        iter++;
-
-        status = gsl_multiroot_fdfsolver_iterate(s);
-
-        if (status)
-          break;
-
-        status = gsl_multiroot_test_residual(s->f, tolerance);
+        if (!steady_state_dll.eval(deepParams, Mx, steadyState))
+          throw SteadyStateException("the steady state DLL failed to compute the steady state");
+        if (checkAnalyticSteadyState)
+          {
+            static_dll.eval(steadyState, Mx, deepParams, residual, NULL, NULL);
+            for (size_t i = 0; i < n_endo; i++)
+              if (!(fabs(residual(i)) < tolerance))
+                throw SteadyStateException("the steady state computed by the steady state DLL is not a solution of the static model");
+          }
+        return;
       }
-    while (status == GSL_CONTINUE && iter < max_iterations);
 
-    if (status != GSL_SUCCESS)
-      throw SteadyStateException(std::string(gsl_strerror(status)));
+    system.deepParams = deepParams.getData();
+    system.n_params = deepParams.getSize();
+    system.x = Mx.getData();
+    system.n_exo = Mx.getCols();
 
-    gsl_vector_memcpy(&ss.vector, gsl_multiroot_fdfsolver_root(s));
+    if (cache == NULL && cacheCapacity > 0)
+      cache = new SteadyStateCache(deepParams.getSize(), n_endo, cacheCapacity);
+    lastRecoveryStart = -1;
 
-    gsl_multiroot_fdfsolver_free(s);
+    // Start from the steady state of the nearest parameters, and from the given guess if that fails
+    bool found = cache != NULL && cache->findNearest(deepParams, yStart) && solveFromStart();
+    if (!found)
+      {
+        yStart = steadyState;
+        found = solveFromStart();
+      }
+    if (!found && recoveryStarts > 0)
+      found = recover();
+    if (!found)
+      throw SteadyStateException("the Newton solver failed to find the steady state");
+
+    steadyState = yStart;
+    if (cache != NULL)
+      cache->insert(deepParams, steadyState);
   }
 };
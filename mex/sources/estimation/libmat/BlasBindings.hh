@@ -97,6 +97,19 @@ namespace blas
           B.getData(), &ldb, &beta, C.getData(), &ldc);
   }
 
+  //! Triangular matrix * vector multiplication, in place
+  //  x = op(A)*x, where A is a n by n triangular matrix
+  template<class Mat, class Vec>
+  inline void
+  trmv(const char *uplo, const char *transa, const char *diag, const Mat &A, Vec &X)
+  {
+    assert(A.getRows() == A.getCols());
+    assert(A.getRows() == X.getSize());
+    blas_int n = A.getRows();
+    blas_int lda = A.getLd(), incx = X.getStride();
+    dtrmv(uplo, transa, diag, &n, A.getData(), &lda, X.getData(), &incx);
+  }
+
   /* Level 3 */
 
   //! General matrix multiplication
@@ -167,6 +180,25 @@ namespace blas
           B.getData(), &ldb, &beta, C.getData(), &ldc);
   }
 
+  //! Triangular matrix * matrix multiplication, in place
+  //  B = alpha*op(A)*B or B = alpha*B*op(A), where A is triangular
+  template<class Mat1, class Mat2>
+  inline void
+  trmm(const char *side, const char *uplo, const char *transa, const char *diag,
+       double alpha, const Mat1 &A, Mat2 &B)
+  {
+    assert(A.getRows() == A.getCols());
+    if (*side == 'L' || *side == 'l')
+      assert(A.getCols() == B.getRows());
+    else if (*side == 'R' || *side == 'r')
+      assert(A.getRows() == B.getCols());
+
+    blas_int m = B.getRows(), n = B.getCols();
+    blas_int lda = A.getLd(), ldb = B.getLd();
+    dtrmm(side, uplo, transa, diag, &m, &n, &alpha, A.getData(), &lda,
+          B.getData(), &ldb);
+  }
+
 } // End of namespace
 
 #endif
@@ -21,31 +21,56 @@
 
 #include <cassert>
 #include <cstdlib>
+#include <algorithm> // For std::max()
 
-double GeneralizedSchurDecomposition::criterium_static;
+__thread double GeneralizedSchurDecomposition::criterium_static;
 
 GeneralizedSchurDecomposition::GeneralizedSchurDecomposition(size_t n_arg, double criterium_arg) :
-  n(n_arg), criterium(criterium_arg)
+  n(n_arg), criterium(criterium_arg), workspace(new LapackWorkspace), ownWorkspace(true)
 {
-  alphar = new double[n];
-  alphai = new double[n];
-  beta = new double[n];
-
-  lwork = 16*n+16; // Same heuristic choice than mjdgges
-  work = new double[(int) lwork];
-  vsl = new double[n*n];
+  reserveWorkspace();
+  workspace->allocate();
+}
 
-  bwork = new lapack_int[n];
+GeneralizedSchurDecomposition::GeneralizedSchurDecomposition(size_t n_arg, double criterium_arg,
+                                                             LapackWorkspace &workspace_arg) :
+  n(n_arg), criterium(criterium_arg), workspace(&workspace_arg), ownWorkspace(false)
+{
+  reserveWorkspace();
 }
 
 GeneralizedSchurDecomposition::~GeneralizedSchurDecomposition()
 {
-  delete[] alphar;
-  delete[] alphai;
-  delete[] beta;
-  delete[] work;
-  delete[] vsl;
-  delete[] bwork;
+  if (ownWorkspace)
+    delete workspace;
+}
+
+void
+GeneralizedSchurDecomposition::reserveWorkspace()
+{
+  eig_handle = workspace->reserveDoubles(3*n + n*n);
+  bwork_handle = workspace->reserveInts(n);
+
+  // Workspace query: the arrays are not referenced
+  lapack_int n2 = n, ld = std::max(n2, (lapack_int) 1), lwork = -1, sdim, info;
+  lapack_int bwork_query;
+  double dummy = 0, work_query = 0;
+  dgges("N", "V", "S", &selctg, &n2, &dummy, &ld, &dummy, &ld,
+        &sdim, &dummy, &dummy, &dummy, &dummy, &ld, &dummy, &ld,
+        &work_query, &lwork, &bwork_query, &info);
+
+  // Never go below the heuristic choice of mjdgges
+  workspace->reserveScratch(lapack::queriedSize(info == 0 ? work_query : 0, 16*n+16));
+}
+
+void
+GeneralizedSchurDecomposition::bindWorkspace()
+{
+  alphar = workspace->getDoubles(eig_handle);
+  alphai = alphar + n;
+  beta = alphai + n;
+  vsl = beta + n;
+  bwork = workspace->getInts(bwork_handle);
 }
 
 lapack_int
@@ -21,17 +21,26 @@
 
 #include "Vector.hh"
 #include "Matrix.hh"
+#include "LapackWorkspace.hh"
 
 class GeneralizedSchurDecomposition
 {
 private:
   const size_t n;
   const double criterium;
-  lapack_int lwork;
-  double *alphar, *alphai, *beta, *vsl, *work;
+  LapackWorkspace *const workspace;
+  const bool ownWorkspace;
+  //! Handles of alphar, alphai, beta and vsl (stored contiguously), and of bwork
+  size_t eig_handle, bwork_handle;
+  double *alphar, *alphai, *beta, *vsl;
   lapack_int *bwork;
-  static double criterium_static;
+  //! Criterium of the current call to dgges(), for selctg(); thread-local, since the callback has no user data
+  static __thread double criterium_static;
   static lapack_int selctg(const double *alphar, const double *alphai, const double *beta);
+  //! Queries the optimal size of the work array, and reserves the workspace
+  void reserveWorkspace();
+  //! Retrieves the pointers into the (allocated) workspace
+  void bindWorkspace();
 public:
   class GSDException
   {
@@ -41,11 +50,12 @@ public:
     {
     };
   };
-  //! \todo Replace heuristic choice for workspace size by a query to determine the optimal size
+  //! Allocates its own workspace
   GeneralizedSchurDecomposition(size_t n_arg, double criterium_arg);
+  //! Reserves space in a shared workspace, which must be allocated by the caller before the first computation
+  GeneralizedSchurDecomposition(size_t n_arg, double criterium_arg, LapackWorkspace &workspace_arg);
   virtual
   ~GeneralizedSchurDecomposition();
-  //! \todo Add a lock around the modification of criterium_static for making it thread-safe
   template<class Mat1, class Mat2, class Mat3>
   void compute(Mat1 &S, Mat2 &T, Mat3 &Z, size_t &sdim) throw (GSDException);
   template<class Mat1, class Mat2, class Mat3, class Mat4, class Mat5>
@@ -70,12 +80,14 @@ GeneralizedSchurDecomposition::compute(Mat1 &S, Mat2 &T, Mat3 &Z, size_t &sdim)
   lapack_int n2 = n;
   lapack_int info, sdim2;
   lapack_int lds = S.getLd(), ldt = T.getLd(), ldz = Z.getLd();
+  lapack_int lwork = workspace->getScratchSize();
 
+  bindWorkspace();
   criterium_static = criterium;
   // Here we are forced to give space for left Schur vectors, even if we don't use them, because of a bug in dgges()
   dgges("N", "V", "S", &selctg, &n2, S.getData(), &lds, T.getData(), &ldt,
         &sdim2, alphar, alphai, beta, vsl, &n2, Z.getData(), &ldz,
-        work, &lwork, bwork, &info);
+        workspace->getScratch(), &lwork, bwork, &info);
 
   if (info != 0)
     throw GSDException(info, n2);
@@ -101,6 +113,7 @@ GeneralizedSchurDecomposition::getGeneralizedEigenvalues(Vec1 &eig_real, Vec2 &e
 {
   assert(eig_real.getSize() == n && eig_cmplx.getSize() == n);
 
+  bindWorkspace();
   double *par = alphar, *pai = alphai, *pb = beta,
     *per = eig_real.getData(), *pei = eig_cmplx.getData();
   while (par < alphar + n)
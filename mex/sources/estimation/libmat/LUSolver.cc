@@ -19,12 +19,21 @@
 
 #include "LUSolver.hh"
 
-LUSolver::LUSolver(size_t dim_arg) : dim(dim_arg)
+LUSolver::LUSolver(size_t dim_arg) : dim(dim_arg),
+                                     workspace(new LapackWorkspace), ownWorkspace(true)
 {
-  ipiv = new lapack_int[dim];
+  ipiv_handle = workspace->reserveInts(dim);
+  workspace->allocate();
+}
+
+LUSolver::LUSolver(size_t dim_arg, LapackWorkspace &workspace_arg) :
+  dim(dim_arg), workspace(&workspace_arg), ownWorkspace(false)
+{
+  ipiv_handle = workspace->reserveInts(dim);
 }
 
 LUSolver::~LUSolver()
 {
-  delete[] ipiv;
+  if (ownWorkspace)
+    delete workspace;
 }
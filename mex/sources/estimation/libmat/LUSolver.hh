@@ -17,16 +17,23 @@
  * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#ifndef _LUSOLVER_HH
+#define _LUSOLVER_HH
+
 #include <cstdlib>
 #include <cassert>
 
 #include <dynlapack.h>
 
+#include "LapackWorkspace.hh"
+
 class LUSolver
 {
 private:
   const size_t dim;
-  lapack_int *ipiv;
+  LapackWorkspace *const workspace;
+  const bool ownWorkspace;
+  size_t ipiv_handle;
 public:
   class LUException
   {
@@ -36,7 +43,10 @@ public:
     {
     };
   };
+  //! Allocates its own workspace
   LUSolver(size_t dim_arg);
+  //! Reserves space in a shared workspace, which must be allocated by the caller before the first computation
+  LUSolver(size_t dim_arg, LapackWorkspace &workspace_arg);
   virtual
   ~LUSolver();
   /*!
@@ -46,21 +56,51 @@ public:
   */
   template<class Mat1, class Mat2>
   void invMult(const char *trans, Mat1 &A, Mat2 &B) throw (LUException);
+  /*!
+    Computes the LU factorization of A, in place.
+    The pivots are kept until the next factorization.
+  */
+  template<class Mat>
+  void factorize(Mat &A) throw (LUException);
+  /*!
+    Computes A^(-1)*B (possibly transposing A), where A is the output of the
+    last call to factorize(). The output is stored in B.
+  */
+  template<class Mat1, class Mat2>
+  void solve(const char *trans, const Mat1 &A, Mat2 &B);
 };
 
 template<class Mat1, class Mat2>
 void
 LUSolver::invMult(const char *trans, Mat1 &A, Mat2 &B) throw (LUException)
+{
+  factorize(A);
+  solve(trans, A, B);
+}
+
+template<class Mat>
+void
+LUSolver::factorize(Mat &A) throw (LUException)
 {
   assert(A.getRows() == dim && A.getCols() == dim);
-  assert(B.getRows() == dim);
   lapack_int n = dim, lda = A.getLd(), info;
-  dgetrf(&n, &n, A.getData(), &lda, ipiv, &info);
+  dgetrf(&n, &n, A.getData(), &lda, workspace->getInts(ipiv_handle), &info);
 
   if (info != 0)
     throw LUException(info);
+}
 
+template<class Mat1, class Mat2>
+void
+LUSolver::solve(const char *trans, const Mat1 &A, Mat2 &B)
+{
+  assert(A.getRows() == dim && A.getCols() == dim);
+  assert(B.getRows() == dim);
+  lapack_int n = dim, lda = A.getLd(), info;
   lapack_int nrhs = B.getCols(), ldb = B.getLd();
-  dgetrs(trans, &n, &nrhs, A.getData(), &lda, ipiv, B.getData(), &ldb, &info);
+  dgetrs(trans, &n, &nrhs, A.getData(), &lda, workspace->getInts(ipiv_handle),
+         B.getData(), &ldb, &info);
   assert(info == 0);
 }
+
+#endif
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LapackWorkspace.hh"
+
+LapackWorkspace::LapackWorkspace() : size(0), scratchSize(0), block(NULL), alignedBlock(NULL)
+{
+}
+
+LapackWorkspace::~LapackWorkspace()
+{
+  delete[] block;
+}
+
+size_t
+LapackWorkspace::reserve(size_t bytes)
+{
+  assert(alignedBlock == NULL);
+  offsets.push_back(size);
+  size += (bytes + alignment - 1) / alignment * alignment;
+  return offsets.size() - 1;
+}
+
+size_t
+LapackWorkspace::reserveDoubles(size_t n)
+{
+  return reserve(n*sizeof(double));
+}
+
+size_t
+LapackWorkspace::reserveInts(size_t n)
+{
+  return reserve(n*sizeof(lapack_int));
+}
+
+void
+LapackWorkspace::reserveScratch(size_t n)
+{
+  assert(alignedBlock == NULL);
+  if (n > scratchSize)
+    scratchSize = n;
+}
+
+void
+LapackWorkspace::allocate()
+{
+  assert(alignedBlock == NULL);
+  block = new char[size + scratchSize*sizeof(double) + alignment];
+  alignedBlock = block + (alignment - ((size_t) block) % alignment) % alignment;
+}
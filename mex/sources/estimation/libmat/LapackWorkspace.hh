@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _LAPACK_WORKSPACE_HH
+#define _LAPACK_WORKSPACE_HH
+
+#include <cstdlib>
+#include <cassert>
+#include <vector>
+
+#include <dynlapack.h>
+
+/*
+  A single aligned memory block holding the scratch space of several
+  LAPACK-based decompositions (QR, generalized Schur, LU, eigenvalues...).
+
+  It is used in two phases:
+  - at construction, each decomposition queries LAPACK for its optimal
+    workspace size, and reserves the space it needs. Arrays that must survive
+    between two LAPACK calls (pivots, Householder scalars, eigenvalues...) are
+    reserved as separate slices, and a handle is returned for each of them. The
+    "work" arrays, which are only used during a single LAPACK call, all share
+    the same scratch area, whose size is the maximum of all requests;
+  - once all decompositions have been constructed, the owner calls allocate(),
+    which performs the only memory allocation.
+
+  Afterwards, retrieving a slice is a mere pointer addition. A workspace must
+  not be shared by decompositions which are used concurrently.
+*/
+class LapackWorkspace
+{
+private:
+  //! Alignment of every slice, in bytes (a cache line)
+  static const size_t alignment = 64;
+  std::vector<size_t> offsets;
+  size_t size, scratchSize;
+  char *block, *alignedBlock;
+  size_t reserve(size_t bytes);
+  // Not copyable
+  LapackWorkspace(const LapackWorkspace &);
+  LapackWorkspace &operator=(const LapackWorkspace &);
+public:
+  LapackWorkspace();
+  virtual ~LapackWorkspace();
+  //! Reserves a slice of n doubles, returns its handle
+  size_t reserveDoubles(size_t n);
+  //! Reserves a slice of n LAPACK integers, returns its handle
+  size_t reserveInts(size_t n);
+  //! Requests a scratch area of at least n doubles
+  void reserveScratch(size_t n);
+  //! Allocates the block; no reservation can be made afterwards
+  void allocate();
+  inline bool
+  isAllocated() const
+  {
+    return alignedBlock != NULL;
+  }
+  inline double *
+  getDoubles(size_t handle)
+  {
+    assert(alignedBlock != NULL && handle < offsets.size());
+    return reinterpret_cast<double *>(alignedBlock + offsets[handle]);
+  }
+  inline lapack_int *
+  getInts(size_t handle)
+  {
+    assert(alignedBlock != NULL && handle < offsets.size());
+    return reinterpret_cast<lapack_int *>(alignedBlock + offsets[handle]);
+  }
+  //! The scratch area is located after all the slices
+  inline double *
+  getScratch()
+  {
+    assert(alignedBlock != NULL);
+    return reinterpret_cast<double *>(alignedBlock + size);
+  }
+  //! Size of the scratch area, in doubles
+  inline size_t
+  getScratchSize() const
+  {
+    return scratchSize;
+  }
+};
+
+namespace lapack
+{
+  //! Converts the result of a workspace query (lwork=-1) into an integer size
+  inline size_t
+  queriedSize(double work_query, size_t minimum)
+  {
+    size_t s = (size_t) work_query;
+    return s < minimum ? minimum : s;
+  }
+} // End of namespace
+
+#endif
@@ -343,6 +343,17 @@ namespace mat
       }
   }
 
+  //! Copies the contiguous block of columns [col_offset, col_offset+dest.getCols()) of src into dest
+  template<class Mat1, class Mat2>
+  inline void
+  cols_copy(const Mat1 &src, size_t col_offset, Mat2 &dest)
+  {
+    assert(src.getRows() == dest.getRows() && col_offset + dest.getCols() <= src.getCols());
+    for (size_t j = 0; j < dest.getCols(); j++)
+      memcpy(dest.getData() + j*dest.getLd(), src.getData() + (col_offset + j)*src.getLd(),
+             src.getRows()*sizeof(double));
+  }
+
   template<class Mat>
   inline void
   col_set(Mat &M, size_t col, size_t row_offset, size_t row_nb, double val)
@@ -17,23 +17,46 @@
  * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <algorithm> // For std::min
+#include <algorithm> // For std::min and std::max
 
 #include "QRDecomposition.hh"
 
 QRDecomposition::QRDecomposition(size_t rows_arg, size_t cols_arg, size_t cols2_arg) :
   rows(rows_arg), cols(cols_arg), mind(std::min(rows, cols)), cols2(cols2_arg),
-  lwork(rows*cols), lwork2(cols2)
+  workspace(new LapackWorkspace), ownWorkspace(true)
 {
-  work = new double[lwork];
-  work2 = new double[lwork2];
+  reserveWorkspace();
+  workspace->allocate();
+}
 
-  tau = new double[mind];
+QRDecomposition::QRDecomposition(size_t rows_arg, size_t cols_arg, size_t cols2_arg,
+                                 LapackWorkspace &workspace_arg) :
+  rows(rows_arg), cols(cols_arg), mind(std::min(rows, cols)), cols2(cols2_arg),
+  workspace(&workspace_arg), ownWorkspace(false)
+{
+  reserveWorkspace();
 }
 
 QRDecomposition::~QRDecomposition()
 {
-  delete[] work;
-  delete[] work2;
-  delete[] tau;
+  if (ownWorkspace)
+    delete workspace;
+}
+
+void
+QRDecomposition::reserveWorkspace()
+{
+  tau_handle = workspace->reserveDoubles(mind);
+
+  // Workspace queries: the arrays are not referenced
+  lapack_int m = rows, n = cols, lda = std::max(m, (lapack_int) 1), lwork = -1, info;
+  double dummy = 0, work_query = 0;
+  dgeqrf(&m, &n, &dummy, &lda, &dummy, &work_query, &lwork, &info);
+  workspace->reserveScratch(lapack::queriedSize(info == 0 ? work_query : 0, std::max(cols, (size_t) 1)));
+
+  lapack_int n2 = cols2, k = mind;
+  work_query = 0;
+  dormqr("L", "T", &m, &n2, &k, &dummy, &lda, &dummy, &dummy, &lda,
+         &work_query, &lwork, &info);
+  workspace->reserveScratch(lapack::queriedSize(info == 0 ? work_query : 0, std::max(cols2, (size_t) 1)));
 }
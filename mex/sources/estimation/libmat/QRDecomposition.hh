@@ -24,6 +24,7 @@
 #include "Vector.hh"
 #include "Matrix.hh"
 #include "BlasBindings.hh"
+#include "LapackWorkspace.hh"
 
 class QRDecomposition
 {
@@ -31,16 +32,22 @@ private:
   const size_t rows, cols, mind;
   //! Number of columns of the matrix to be left-multiplied by Q
   const size_t cols2;
-  lapack_int lwork, lwork2;
-  double *work, *work2, *tau;
+  LapackWorkspace *const workspace;
+  const bool ownWorkspace;
+  //! Handle of the Householder scalars, which must survive between dgeqrf and dormqr
+  size_t tau_handle;
+  //! Queries the optimal sizes of the work arrays of dgeqrf and dormqr, and reserves the workspace
+  void reserveWorkspace();
 public:
   /*!
-    \todo Replace heuristic choice for workspace size by a query to determine the optimal size
+    Allocates its own workspace
     \param[in] rows_arg Number of rows of the matrix to decompose
     \param[in] cols_arg Number of columns of the matrix to decompose
     \param[in] cols2_arg Number of columns of the matrix to be multiplied by Q
   */
   QRDecomposition(size_t rows_arg, size_t cols_arg, size_t cols2_arg);
+  //! Reserves space in a shared workspace, which must be allocated by the caller before the first computation
+  QRDecomposition(size_t rows_arg, size_t cols_arg, size_t cols2_arg, LapackWorkspace &workspace_arg);
   virtual
   ~QRDecomposition();
   //! Performs the QR decomposition of a matrix, and left-multiplies another matrix by Q
@@ -51,23 +58,57 @@ public:
   */
   template<class Mat1, class Mat2>
   void computeAndLeftMultByQ(Mat1 &A, const char *trans, Mat2 &C);
+  //! Performs the QR decomposition of a matrix
+  /*!
+    \param[in,out] A On input, the matrix to be decomposed. On output, equals to the output of dgeqrf
+  */
+  template<class Mat>
+  void compute(Mat &A);
+  //! Left-multiplies a matrix by the Q of the last decomposition
+  /*!
+    Can be called several times after a single call to compute(), as long as
+    the workspace is not used by another QR decomposition in between.
+    \param[in] A The output of the last call to compute() (only temporarily modified)
+    \param[in] trans Specifies whether Q should be transposed before the multiplication, either "T" or "N"
+    \param[in,out] C The matrix to be left-multiplied by Q, modified in place
+  */
+  template<class Mat1, class Mat2>
+  void leftMultByQ(Mat1 &A, const char *trans, Mat2 &C);
 };
 
 template<class Mat1, class Mat2>
 void
 QRDecomposition::computeAndLeftMultByQ(Mat1 &A, const char *trans, Mat2 &C)
+{
+  compute(A);
+  leftMultByQ(A, trans, C);
+}
+
+template<class Mat>
+void
+QRDecomposition::compute(Mat &A)
 {
   assert(A.getRows() == rows && A.getCols() == cols);
-  assert(C.getRows() == rows && C.getCols() == cols2);
 
   lapack_int m = rows, n = cols, lda = A.getLd();
   lapack_int info;
-  dgeqrf(&m, &n, A.getData(), &lda, tau, work, &lwork, &info);
+  lapack_int lwork = workspace->getScratchSize();
+  dgeqrf(&m, &n, A.getData(), &lda, workspace->getDoubles(tau_handle),
+         workspace->getScratch(), &lwork, &info);
   assert(info == 0);
+}
+
+template<class Mat1, class Mat2>
+void
+QRDecomposition::leftMultByQ(Mat1 &A, const char *trans, Mat2 &C)
+{
+  assert(A.getRows() == rows && A.getCols() == cols);
+  assert(C.getRows() == rows && C.getCols() == cols2);
 
-  n = cols2;
-  lapack_int k = mind, ldc = C.getLd();
-  dormqr("L", trans, &m, &n, &k, A.getData(), &lda, tau, C.getData(), &ldc,
-         work2, &lwork2, &info);
+  lapack_int m = rows, n = cols2, lda = A.getLd();
+  lapack_int k = mind, ldc = C.getLd(), info;
+  lapack_int lwork = workspace->getScratchSize();
+  dormqr("L", trans, &m, &n, &k, A.getData(), &lda, workspace->getDoubles(tau_handle),
+         C.getData(), &ldc, workspace->getScratch(), &lwork, &info);
   assert(info == 0);
 }
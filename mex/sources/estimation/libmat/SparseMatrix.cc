@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SparseMatrix.hh"
+
+CSCMatrix::CSCMatrix(size_t rows_arg, size_t cols_arg) :
+  rows(rows_arg), cols(cols_arg), colPtr(cols_arg + 1, 0)
+{
+}
+
+void
+CSCMatrix::setPattern(const std::vector<size_t> &colPtr_arg, const std::vector<size_t> &rowInd_arg)
+{
+  assert(colPtr_arg.size() == cols + 1 && colPtr_arg[0] == 0
+         && colPtr_arg[cols] == rowInd_arg.size());
+  colPtr = colPtr_arg;
+  rowInd = rowInd_arg;
+  values.assign(rowInd.size(), 0.0);
+}
+
+double
+CSCMatrix::operator()(size_t i, size_t j) const
+{
+  assert(i < rows && j < cols);
+  for (size_t k = colPtr[j]; k < colPtr[j+1]; k++)
+    if (rowInd[k] == i)
+      return values[k];
+  return 0.0;
+}
+
+std::ostream &
+operator<<(std::ostream &out, const CSCMatrix &M)
+{
+  Matrix dense(M.getRows(), M.getCols());
+  mat::set_dense(dense, M);
+  out << dense;
+  return out;
+}
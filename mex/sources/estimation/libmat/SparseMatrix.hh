@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SPARSE_MATRIX_HH
+#define _SPARSE_MATRIX_HH
+
+#include <cstdlib>
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include "Matrix.hh"
+
+/*
+  A sparse matrix in compressed sparse column (CSC) format, as produced by
+  Dynare for model jacobians: the row indices of the nonzero elements of
+  column j are rowInd[colPtr[j]] to rowInd[colPtr[j+1]-1], and the
+  corresponding values are stored at the same positions in the values array.
+  Indices follow C convention (starting at zero).
+
+  The sparsity pattern is fixed once (it is a property of the model), and
+  only the values are updated afterwards, in place.
+
+  This class does not implement the "matrix concept". Some of the templated
+  functions of the mat namespace are overloaded for it, so that a dense and
+  a sparse matrix can be used interchangeably as a source.
+*/
+class CSCMatrix
+{
+private:
+  const size_t rows, cols;
+  std::vector<size_t> colPtr, rowInd;
+  std::vector<double> values;
+public:
+  //! Creates a matrix with no nonzero element
+  CSCMatrix(size_t rows_arg, size_t cols_arg);
+  //! Creates a matrix with the sparsity pattern and values of the nonzero elements of a dense matrix
+  template<class Mat>
+  explicit CSCMatrix(const Mat &dense);
+  virtual ~CSCMatrix()
+  {
+  };
+  /*!
+    Sets the sparsity pattern; values are set to zero.
+    \param colPtr_arg Column pointers, of size cols+1
+    \param rowInd_arg Row indices, sorted within each column
+  */
+  void setPattern(const std::vector<size_t> &colPtr_arg, const std::vector<size_t> &rowInd_arg);
+  inline size_t
+  getRows() const
+  {
+    return rows;
+  }
+  inline size_t
+  getCols() const
+  {
+    return cols;
+  }
+  inline size_t
+  getNnz() const
+  {
+    return rowInd.size();
+  }
+  //! Position in the values array of the first nonzero element of column j
+  inline size_t
+  colBegin(size_t j) const
+  {
+    return colPtr[j];
+  }
+  //! Position in the values array past the last nonzero element of column j
+  inline size_t
+  colEnd(size_t j) const
+  {
+    return colPtr[j+1];
+  }
+  inline size_t
+  rowIndex(size_t k) const
+  {
+    return rowInd[k];
+  }
+  inline double *
+  getValues()
+  {
+    return values.empty() ? NULL : &values[0];
+  }
+  inline const double *
+  getValues() const
+  {
+    return values.empty() ? NULL : &values[0];
+  }
+  //! Retrieves an element (zero if outside of the sparsity pattern); costs a search within the column
+  double operator()(size_t i, size_t j) const;
+};
+
+std::ostream &operator<<(std::ostream &out, const CSCMatrix &M);
+
+template<class Mat>
+CSCMatrix::CSCMatrix(const Mat &dense) : rows(dense.getRows()), cols(dense.getCols())
+{
+  colPtr.push_back(0);
+  for (size_t j = 0; j < cols; j++)
+    {
+      for (size_t i = 0; i < rows; i++)
+        if (dense(i, j) != 0.0)
+          {
+            rowInd.push_back(i);
+            values.push_back(dense(i, j));
+          }
+      colPtr.push_back(rowInd.size());
+    }
+}
+
+namespace mat
+{
+  //! Copies a sparse matrix into a dense one, of the same size
+  template<class Mat>
+  void
+  set_dense(Mat &dest, const CSCMatrix &src)
+  {
+    assert(dest.getRows() == src.getRows() && dest.getCols() == src.getCols());
+    dest.setAll(0.0);
+    const double *v = src.getValues();
+    for (size_t j = 0; j < src.getCols(); j++)
+      {
+        double *col = dest.getData() + j*dest.getLd();
+        for (size_t k = src.colBegin(j); k < src.colEnd(j); k++)
+          col[src.rowIndex(k)] = v[k];
+      }
+  }
+
+  //! Copies (part of) a column of a sparse matrix into a dense matrix, zeros included
+  template<class Mat>
+  inline void
+  col_copy(const CSCMatrix &src, size_t col_src, size_t row_offset_src, size_t row_nb,
+           Mat &dest, size_t col_dest, size_t row_offset_dest)
+  {
+    assert(col_src < src.getCols() && col_dest < dest.getCols()
+           && row_offset_src+row_nb <= src.getRows()
+           && row_offset_dest+row_nb <= dest.getRows());
+    double *col = dest.getData() + row_offset_dest + col_dest*dest.getLd();
+    memset(col, 0, row_nb*sizeof(double));
+    const double *v = src.getValues();
+    for (size_t k = src.colBegin(col_src); k < src.colEnd(col_src); k++)
+      {
+        size_t i = src.rowIndex(k);
+        if (i >= row_offset_src && i < row_offset_src + row_nb)
+          col[i - row_offset_src] = v[k];
+      }
+  }
+
+  template<class Mat>
+  inline void
+  col_copy(const CSCMatrix &src, size_t col_src, Mat &dest, size_t col_dest)
+  {
+    assert(src.getRows() == dest.getRows());
+    col_copy(src, col_src, 0, src.getRows(), dest, col_dest, 0);
+  }
+
+  //! Copies the contiguous block of columns [col_offset, col_offset+dest.getCols()) of a sparse matrix into a dense one
+  template<class Mat>
+  void
+  cols_copy(const CSCMatrix &src, size_t col_offset, Mat &dest)
+  {
+    assert(src.getRows() == dest.getRows() && col_offset + dest.getCols() <= src.getCols());
+    for (size_t j = 0; j < dest.getCols(); j++)
+      col_copy(src, col_offset + j, dest, j);
+  }
+
+  /*!
+    Computes C = alpha*A(:, col_offset:col_offset+B.getRows()-1)*B + beta*C,
+    where A is sparse. The cost is proportional to the number of nonzero
+    elements of the block of A times the number of columns of B.
+  */
+  template<class Mat1, class Mat2>
+  void
+  sparse_gemm(double alpha, const CSCMatrix &A, size_t col_offset, const Mat1 &B,
+              double beta, Mat2 &C)
+  {
+    assert(A.getRows() == C.getRows() && B.getCols() == C.getCols()
+           && col_offset + B.getRows() <= A.getCols());
+    const double *v = A.getValues();
+    for (size_t j = 0; j < C.getCols(); j++)
+      {
+        double *c = C.getData() + j*C.getLd();
+        if (beta == 0.0)
+          memset(c, 0, C.getRows()*sizeof(double));
+        else if (beta != 1.0)
+          for (size_t i = 0; i < C.getRows(); i++)
+            c[i] *= beta;
+        for (size_t l = 0; l < B.getRows(); l++)
+          {
+            double b = alpha*B(l, j);
+            if (b == 0.0)
+              continue;
+            for (size_t k = A.colBegin(col_offset + l); k < A.colEnd(col_offset + l); k++)
+              c[A.rowIndex(k)] += v[k]*b;
+          }
+      }
+  }
+} // End of namespace
+
+#endif
@@ -20,27 +20,52 @@
 #include "VDVEigDecomposition.hh"
 
 VDVEigDecomposition::VDVEigDecomposition(const Matrix &m) throw (VDVEigException) :
-  lda(m.getLd()), n(m.getCols()), lwork(-1),
-  info(0),   converged(false), V(m), D(n)
+  lda(m.getLd()), n(m.getCols()),
+  info(0), workspace(new LapackWorkspace), ownWorkspace(true),
+  converged(false), V(m), D(n)
 {
   if (m.getRows() != m.getCols())
-    throw (VDVEigException(info, "Matrix is not square in VDVEigDecomposition constructor"));
+    {
+      delete workspace;
+      throw (VDVEigException(info, "Matrix is not square in VDVEigDecomposition constructor"));
+    }
 
-  double tmpwork;
-  dsyev("V", "U", &n, V.getData(), &lda, D.getData(), &tmpwork, &lwork, &info);
-  lwork = (lapack_int) tmpwork;
-  work = new double[lwork];
-  if (info < 0)
-    throw (VDVEigException(info, "Internal error in VDVEigDecomposition constructor"));
+  reserveWorkspace();
+  workspace->allocate();
 }
 
 VDVEigDecomposition::VDVEigDecomposition(size_t inn) throw (VDVEigException) :
-  lda(inn), n(inn), lwork(3*inn-1),
-  info(0),   converged(false), V(inn), D(inn)
+  lda(inn), n(inn),
+  info(0), workspace(new LapackWorkspace), ownWorkspace(true),
+  converged(false), V(inn), D(inn)
+{
+  reserveWorkspace();
+  workspace->allocate();
+};
+
+VDVEigDecomposition::VDVEigDecomposition(size_t inn, LapackWorkspace &workspace_arg) throw (VDVEigException) :
+  lda(inn), n(inn),
+  info(0), workspace(&workspace_arg), ownWorkspace(false),
+  converged(false), V(inn), D(inn)
 {
-  work = new double[lwork];
+  reserveWorkspace();
 };
 
+void
+VDVEigDecomposition::reserveWorkspace() throw (VDVEigException)
+{
+  double tmpwork = 0;
+  lapack_int tmplwork = -1, ld = lda > 1 ? lda : 1;
+  dsyev("V", "U", &n, V.getData(), &ld, D.getData(), &tmpwork, &tmplwork, &info);
+  if (info < 0)
+    {
+      if (ownWorkspace)
+        delete workspace;
+      throw (VDVEigException(info, "Internal error in VDVEigDecomposition constructor"));
+    }
+  workspace->reserveScratch(lapack::queriedSize(tmpwork, n > 0 ? 3*n-1 : 1));
+}
+
 std::ostream &
 operator<<(std::ostream &out, const VDVEigDecomposition::VDVEigException &e)
 {
@@ -29,17 +29,17 @@
 #include "Vector.hh"
 #include "Matrix.hh"
 #include <dynlapack.h>
+#include "LapackWorkspace.hh"
 
 class VDVEigDecomposition
 {
   lapack_int lda, n;
-  lapack_int lwork, info;
-  double *work;
+  lapack_int info;
+  LapackWorkspace *const workspace;
+  const bool ownWorkspace;
   bool converged;
   Matrix V;
   Vector D;
-public:
-
 public:
   class VDVEigException
   {
@@ -51,6 +51,10 @@ public:
     {
     };
   };
+private:
+  //! Queries the optimal size of the dsyev work array, once and for all
+  void reserveWorkspace() throw (VDVEigException);
+public:
 
   /**
    *  This constructor only creates optimal workspace using
@@ -64,9 +68,16 @@ public:
    */
   VDVEigDecomposition(size_t n) throw (VDVEigException);
 
+  /**
+   *  Same as above, but reserves space in a shared workspace, which
+   *  must be allocated by the caller before the first calculation
+   */
+  VDVEigDecomposition(size_t n, LapackWorkspace &workspace_arg) throw (VDVEigException);
+
   virtual ~VDVEigDecomposition()
   {
-    delete[] work;
+    if (ownWorkspace)
+      delete workspace;
   };
   template <class Mat>
   void calculate(const Mat &H) throw (VDVEigException);
@@ -101,17 +112,10 @@ VDVEigDecomposition::calculate(const Mat &m) throw (VDVEigException)
   if (m.getCols() != (size_t) n  || m.getLd() != (size_t) lda)
     throw (VDVEigException(info, "Matrix not matching VDVEigDecomposition class"));
 
-  double tmpwork;
-  lapack_int tmplwork = -1;
+  // The optimal workspace size only depends on n, and has been queried at construction
+  lapack_int lwork = workspace->getScratchSize();
   V = m;
-  dsyev("V", "U", &n, V.getData(), &lda, D.getData(), &tmpwork, &tmplwork, &info);
-  if (lwork < (lapack_int) tmpwork)
-    {
-      lwork = (lapack_int) tmpwork;
-      delete[] work;
-      work = new double[lwork];
-    }
-  dsyev("V", "U", &n, V.getData(), &lda, D.getData(), work, &lwork, &info);
+  dsyev("V", "U", &n, V.getData(), &lda, D.getData(), workspace->getScratch(), &lwork, &info);
 
   if (info < 0)
     throw (VDVEigException(info, "Internal error in VDVEigDecomposition calculation"));
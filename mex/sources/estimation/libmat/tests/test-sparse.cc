@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+
+#include "BlasBindings.hh"
+#include "SparseMatrix.hh"
+
+int
+main(int argc, char **argv)
+{
+  size_t m = 4, n = 5, p = 3;
+
+  double A_data[] = { 1, 0, 0, -2,
+                      0, 0, 0, 0,
+                      0, 3, 0, 0,
+                      4, 0, 5, 6,
+                      0, -7, 0, 0 };
+  MatrixView A(A_data, m, n, m);
+  CSCMatrix S(A);
+
+  std::cout << "S =" << std::endl << S << std::endl;
+
+  assert(S.getNnz() == 7);
+  assert(S.colBegin(1) == S.colEnd(1));
+  for (size_t i = 0; i < m; i++)
+    for (size_t j = 0; j < n; j++)
+      assert(S(i, j) == A(i, j));
+
+  // Conversion to dense
+  Matrix A2(m, n);
+  mat::set_dense(A2, S);
+  mat::sub(A2, A);
+  assert(mat::nrminf(A2) < 1e-15);
+
+  // Column copies, with and without row offsets
+  Matrix C(m, 2), C2(m, 2);
+  C.setAll(1.0);
+  mat::col_copy(S, 3, C, 1);
+  mat::col_copy(S, 2, 1, 2, C, 0, 2);
+  assert(C(0, 1) == 4 && C(1, 1) == 0 && C(2, 1) == 5 && C(3, 1) == 6);
+  assert(C(0, 0) == 1 && C(1, 0) == 1 && C(2, 0) == 3 && C(3, 0) == 0);
+
+  mat::cols_copy(S, 3, C2);
+  mat::cols_copy(A, 3, C);
+  mat::sub(C2, C);
+  assert(mat::nrminf(C2) < 1e-15);
+
+  // Product of a block of columns with a dense matrix
+  Matrix B(3, p), D(m, p), D2(m, p);
+  for (size_t i = 0; i < 3; i++)
+    for (size_t j = 0; j < p; j++)
+      B(i, j) = (double) (i+1) - j;
+  D.setAll(1.0);
+  D2.setAll(1.0);
+  mat::sparse_gemm(2.0, S, 1, B, 0.5, D);
+  blas::gemm("N", "N", 2.0, MatrixView(A_data + m, m, 3, m), B, 0.5, D2);
+
+  std::cout << "D =" << std::endl << D << std::endl;
+
+  mat::sub(D2, D);
+  assert(mat::nrminf(D2) < 1e-14);
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+
+#include "BlasBindings.hh"
+#include "QRDecomposition.hh"
+#include "LUSolver.hh"
+
+int
+main(int argc, char **argv)
+{
+  size_t m = 4, n = 3;
+
+  // QR and LU share the same workspace, and are used one after the other
+  LapackWorkspace workspace;
+  QRDecomposition QRD(m, n, m, workspace);
+  LUSolver LU(n, workspace);
+  workspace.allocate();
+  assert(workspace.getScratchSize() >= m);
+
+  // Reference results, computed with private workspaces
+  QRDecomposition QRD_ref(m, n, m);
+  LUSolver LU_ref(n);
+
+  Matrix S(m, n), S_ref(m, n), Q(m), Q_ref(m);
+  for (size_t i = 0; i < m; i++)
+    for (size_t j = 0; j < n; j++)
+      S(i, j) = i*n + j + 1;
+  S_ref = S;
+  mat::set_identity(Q);
+  mat::set_identity(Q_ref);
+
+  double A_data[] = { -1, 2, 3,
+                      4, -5, 6,
+                      7, 8, -9 };
+  Matrix A(n), A_ref(n), B(n, m), B_ref(n, m);
+  A = MatrixView(A_data, n, n, n);
+  A_ref = A;
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < m; j++)
+      B(i, j) = (double) (i+1) / (j+1);
+  B_ref = B;
+
+  // Repeat, to check that the scratch area does not leak state between calls
+  for (int k = 0; k < 2; k++)
+    {
+      QRD.computeAndLeftMultByQ(S, "N", Q);
+      LU.invMult("N", A, B);
+    }
+  for (int k = 0; k < 2; k++)
+    {
+      QRD_ref.computeAndLeftMultByQ(S_ref, "N", Q_ref);
+      LU_ref.invMult("N", A_ref, B_ref);
+    }
+
+  std::cout << "Q =" << std::endl << Q << std::endl
+            << "A\\B =" << std::endl << B << std::endl;
+
+  mat::sub(Q, Q_ref);
+  assert(mat::nrminf(Q) < 1e-12);
+  mat::sub(B, B_ref);
+  assert(mat::nrminf(B) < 1e-12);
+}
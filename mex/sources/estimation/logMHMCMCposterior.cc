@@ -21,18 +21,23 @@
 #include <vector>
 #include <algorithm>
 #include <functional>
+#include <limits>
+#include <memory>
+#include <sstream>
 
 #include "Vector.hh"
 #include "Matrix.hh"
 #include "LogPosteriorDensity.hh"
 #include "RandomWalkMetropolisHastings.hh"
+#include "AdaptiveProposal.hh"
+#include "thread_pool.hh"
+#include "background_worker.hh"
 
 #include <dynmex.h>
 #if defined MATLAB_MEX_FILE
-# include "mat.h"
-#else   //  OCTAVE_MEX_FILE e.t.c.
-# include "matio.h"
+# include "mat.h" // for reading the interim draws files
 #endif
+#include "matio.h"
 
 #if defined(_WIN32) || defined(__CYGWIN32__) || defined(WINDOWS)
 # define DIRECTORY_SEPARATOR "\\"
@@ -115,38 +120,394 @@ fillEstParamsInfo(const mxArray *estim_params_info, EstimatedParameter::pType ty
     }
 }
 
+/**
+ * State of one MH block (chain). Everything the sampler modifies is owned by
+ * the chain, so that the chains can run concurrently; the MATLAB arrays of
+ * draws are only created, resized, copied for the file writer and destroyed
+ * by the main thread, the workers merely fill their data.
+ */
+struct MHChain
+{
+  //! Number of the MH block, starting at 1
+  const size_t b;
+  LogPosteriorDensity *lpd;
+  RandomWalkMetropolisHastings *rwmh;
+  Proposal *pdd;
+  MHTraceSink *traceSink;
+  //! Copies of the model state, updated by the posterior evaluations of this chain
+  Vector steadyState, deepParams, startParams;
+  Matrix Q, H;
+  //! Log posterior density at the current state, carried from one file to the next
+  double currentLogPost;
+  mxArray *mxMhLogPostDensPtr, *mxMhParamDrawsPtr;
+  //! Data of the two arrays above, for the workers
+  double *mhLogPostDensData, *mhParamDrawsData;
+  //! Number of draws of the current file, first draw to compute and number of draws done
+  size_t currInitSizeArray, irun, j;
+  //! True when the current file has been read from disk and must be completed
+  bool openOldFile;
+  //! Whether the chain runs in the current round
+  bool active;
+  double sux, jsux;
+  //! Error code (as returned by sampleMHMC) and message of an exception thrown by the sampler
+  int iret;
+  std::string errorMessage;
+
+  MHChain(size_t b_arg, size_t npar, const VectorView &steadyState_arg, const VectorView &deepParams_arg,
+          const MatrixView &Q_arg, const Matrix &H_arg) :
+    b(b_arg), lpd(NULL), rwmh(NULL), pdd(NULL), traceSink(NULL),
+    steadyState(steadyState_arg.getSize()), deepParams(deepParams_arg.getSize()), startParams(npar),
+    Q(Q_arg.getRows(), Q_arg.getCols()), H(H_arg),
+    currentLogPost(std::numeric_limits<double>::quiet_NaN()), mxMhLogPostDensPtr(NULL), mxMhParamDrawsPtr(NULL),
+    mhLogPostDensData(NULL), mhParamDrawsData(NULL),
+    currInitSizeArray(0), irun(0), j(0), openOldFile(false), active(false), sux(0), jsux(0), iret(0)
+  {
+    steadyState = steadyState_arg;
+    deepParams = deepParams_arg;
+    Q = Q_arg;
+  };
+  ~MHChain()
+  {
+    if (mxMhLogPostDensPtr)
+      mxDestroyArray(mxMhLogPostDensPtr);
+    if (mxMhParamDrawsPtr)
+      mxDestroyArray(mxMhParamDrawsPtr);
+    delete rwmh;
+    delete lpd;
+    delete pdd;
+    delete traceSink;
+  };
+
+private:
+  // Not copyable
+  MHChain(const MHChain &);
+  MHChain &operator=(const MHChain &);
+};
+
+//! Owns its chains, so that they are destroyed when logMCMCposterior exits, including by an exception
+class MHChains : public std::vector<MHChain *>
+{
+public:
+  MHChains()
+  {
+  };
+  ~MHChains()
+  {
+    for (iterator it = begin(); it != end(); ++it)
+      delete *it;
+  };
+private:
+  // Not copyable
+  MHChains(const MHChains &);
+  MHChains &operator=(const MHChains &);
+};
+
+/**
+ * To be called in a catch block: returns the error code of the exception being
+ * handled, and describes it in message.
+ */
 int
-sampleMHMC(LogPosteriorDensity &lpd, RandomWalkMetropolisHastings &rwmh,
-           VectorView &steadyState, VectorConstView &estParams, VectorView &deepParams, const MatrixConstView &data,
-           MatrixView &Q, Matrix &H, size_t presampleStart, const VectorConstView &nruns,
-           size_t fblock, size_t nBlocks, Proposal pdd, EstimatedParametersDescription &epd,
-           const std::string &resultsFileStem, size_t console_mode, size_t load_mh_file)
+describeMHException(std::string &message)
+{
+  std::ostringstream ss;
+  int iret;
+  try
+    {
+      throw;
+    }
+  catch (const TSException &tse)
+    {
+      iret = -100;
+      ss << " TSException Exception in RandomWalkMH dynamic_dll: " << tse.getMessage() << " \n";
+    }
+  catch (const DecisionRules::BlanchardKahnException &bke)
+    {
+      iret = -90;
+      ss << " Too many Blanchard-Kahn Exceptions in RandomWalkMH : n_fwrd_vars " << bke.n_fwrd_vars
+         << " n_explosive_eigenvals " << bke.n_explosive_eigenvals << " \n";
+    }
+  catch (const GeneralizedSchurDecomposition::GSDException &gsde)
+    {
+      iret = -80;
+      ss << " GeneralizedSchurDecomposition Exception in RandomWalkMH: info " << gsde.info << ", n " << gsde.n << "  \n";
+    }
+  catch (const LUSolver::LUException &lue)
+    {
+      iret = -70;
+      ss << " LU Exception in RandomWalkMH : info " << lue.info << " \n";
+    }
+  catch (const VDVEigDecomposition::VDVEigException &vdve)
+    {
+      iret = -60;
+      ss << " VDV Eig Exception in RandomWalkMH : " << vdve.message << " ,  info: " << vdve.info << "\n";
+    }
+  catch (const DiscLyapFast::DLPException &dlpe)
+    {
+      iret = -50;
+      ss << " Lyapunov solver Exception in RandomWalkMH : " << dlpe.message << " ,  info: " << dlpe.info << "\n";
+    }
+  catch (const std::runtime_error &re)
+    {
+      iret = -3;
+      ss << " Runtime Error Exception in RandomWalkMH: " << re.what() << " \n";
+    }
+  catch (const std::exception &e)
+    {
+      iret = -2;
+      ss << " Standard System Exception in RandomWalkMH: " << e.what() << " \n";
+    }
+  catch (...)
+    {
+      iret = -1000;
+      ss << " Unknown unhandled Exception in RandomWalkMH! \n";
+    }
+  message = ss.str();
+  return iret;
+}
+
+/**
+ * Runs the current file of every active chain. Exceptions are caught and
+ * stored in the chain, to be reported by the main thread.
+ */
+class MHChainTask : public ThreadPool::Task
+{
+private:
+  std::vector<MHChain *> &chains;
+  const size_t npar;
+  const MatrixConstView &data;
+  const size_t presampleStart;
+  EstimatedParametersDescription &epd;
+public:
+  MHChainTask(std::vector<MHChain *> &chains_arg, size_t npar_arg, const MatrixConstView &data_arg,
+              size_t presampleStart_arg, EstimatedParametersDescription &epd_arg) :
+    chains(chains_arg), npar(npar_arg), data(data_arg), presampleStart(presampleStart_arg), epd(epd_arg)
+  {
+  };
+  virtual void
+  run(size_t item, size_t worker)
+  {
+    MHChain &c = *chains[item];
+    if (!c.active)
+      return;
+    VectorView mhLogPostDens(c.mhLogPostDensData, c.currInitSizeArray, (size_t) 1);
+    MatrixView mhParamDraws(c.mhParamDrawsData, c.currInitSizeArray, npar, c.currInitSizeArray);
+    VectorView steadyState(c.steadyState, 0, c.steadyState.getSize());
+    VectorView deepParams(c.deepParams, 0, c.deepParams.getSize());
+    MatrixView Q(c.Q, 0, 0, c.Q.getRows(), c.Q.getCols());
+    try
+      {
+        c.jsux = c.rwmh->compute(mhLogPostDens, mhParamDraws, steadyState, c.startParams, c.currentLogPost, deepParams,
+                                 data, Q, c.H, presampleStart, c.irun, c.currInitSizeArray, *c.lpd, *c.pdd, epd);
+        c.irun = c.currInitSizeArray;
+        c.sux += c.jsux*c.currInitSizeArray;
+        c.j += c.currInitSizeArray;
+      }
+    catch (...)
+      {
+        c.iret = describeMHException(c.errorMessage);
+      }
+  };
+};
+
+//! (Re)allocates the draws arrays of the chain if their size must change; returns false on failure
+bool
+allocateDraws(MHChain &c, size_t size, size_t npar)
+{
+  if (c.currInitSizeArray == size && c.mxMhLogPostDensPtr && c.mxMhParamDrawsPtr)
+    return true;
+  // new or different size result arrays/matrices
+  c.currInitSizeArray = size;
+  if (c.mxMhLogPostDensPtr)
+    mxDestroyArray(c.mxMhLogPostDensPtr);                                 // log post density array
+  c.mxMhLogPostDensPtr = mxCreateDoubleMatrix(size, 1, mxREAL);
+  if (c.mxMhLogPostDensPtr == NULL)
+    {
+      mexPrintf("Metropolis-Hastings mxMhLogPostDensPtr Initialisation failed!\n");
+      return false;
+    }
+  if (c.mxMhParamDrawsPtr)
+    mxDestroyArray(c.mxMhParamDrawsPtr);                                  // accepted MCMC MH draws
+  c.mxMhParamDrawsPtr =  mxCreateDoubleMatrix(size, npar,  mxREAL);
+  if (c.mxMhParamDrawsPtr == NULL)
+    {
+      mexPrintf("Metropolis-Hastings mxMhParamDrawsPtr Initialisation failed!\n");
+      return false;
+    }
+  return true;
+}
+
+/**
+ * Saves the MH files completed by a round of the chains, and appends their
+ * summary to metropolis.log, in the order of the blocks. It runs in the
+ * background while the chains fill the next files. It owns copies of the
+ * draws, and writes them with MATIO, not with the MEX API or the MAT-file
+ * library of MATLAB, which must not be used outside the main thread. Errors
+ * are stored in errorMessage, to be reported by the main thread.
+ */
+class MHFileWriter : public BackgroundWorker::Job
 {
+public:
+  struct File
+  {
+    size_t b, newFile, size;
+    double jsux;
+    //! Copies of logpo2 and of x2 (by columns)
+    std::vector<double> logPostDens, paramDraws;
+  };
+  std::vector<File> files;
+  std::string errorMessage;
+
+  MHFileWriter(const std::string &resultsFileStem_arg, size_t npar_arg) :
+    resultsFileStem(resultsFileStem_arg), npar(npar_arg), MinMax(npar_arg, 2)
+  {
+  };
+  virtual void
+  run()
+  {
+    for (size_t k = 0; k < files.size(); ++k)
+      if (!write(files[k]))
+        return;
+  };
+
+private:
   enum {iMin, iMax};
+  const std::string resultsFileStem;
+  const size_t npar;
+  Matrix MinMax;
+
+  bool
+  write(File &f)
+  {
+    const size_t b = f.b;
+    double dsum, dmax, dmin;
+    std::string mhFName;
+    std::stringstream ssFName;
+#if MATIO_MAJOR_VERSION > 1 || (MATIO_MAJOR_VERSION == 1 && MATIO_MINOR_VERSION >= 5)
+    size_t dims[2];
+    const matio_compression compression = MAT_COMPRESSION_NONE;
+#else
+    int dims[2];
+    const int compression = COMPRESSION_NONE;
+#endif
+    mat_t *drawmat;
+    matvar_t *matvar;
+    int matfStatus;
+    FILE *fidlog;  // log file
+    VectorView mhLogPostDens(&f.logPostDens[0], f.size, (size_t) 1);
+    MatrixView mhParamDraws(&f.paramDraws[0], f.size, npar, f.size);
+
+    // % Now I save the simulations
+    // save draw  2 mat file ([MhDirectoryName '/' ModelName '_mh' int2str(NewFile(b)) '_blck' int2str(b) '.mat'],'x2','logpo2');
+    ssFName.clear();
+    ssFName.str("");
+    ssFName << resultsFileStem << DIRECTORY_SEPARATOR << "metropolis" << DIRECTORY_SEPARATOR << resultsFileStem << "_mh" << f.newFile << "_blck" << b << ".mat";
+    mhFName = ssFName.str();
+    drawmat = Mat_Create(mhFName.c_str(), NULL);
+    if (drawmat == 0)
+      {
+        errorMessage = "Error in MH: Can not open draws Mat file for writing:  " + mhFName + " \n";
+        return false;
+      }
+    dims[0] = f.size;
+    dims[1] = npar;
+    matvar = Mat_VarCreate("x2", MAT_C_DOUBLE, MAT_T_DOUBLE, 2, dims, &f.paramDraws[0], 0);
+    matfStatus = Mat_VarWrite(drawmat, matvar, compression);
+    Mat_VarFree(matvar);
+    if (matfStatus)
+      {
+        errorMessage = "Error in MH: Can not use draws Mat file for writing:  " + mhFName + " \n";
+        return false;
+      }
+    //matfStatus = matPutVariable(drawmat, "logpo2", mxMhLogPostDensPtr);
+    dims[1] = 1;
+    matvar = Mat_VarCreate("logpo2", MAT_C_DOUBLE, MAT_T_DOUBLE, 2, dims, &f.logPostDens[0], 0);
+    matfStatus = Mat_VarWrite(drawmat, matvar, compression);
+    Mat_VarFree(matvar);
+    if (matfStatus)
+      {
+        errorMessage = "Error in MH: Can not usee draws Mat file for writing:  " + mhFName + " \n";
+        return false;
+      }
+    Mat_Close(drawmat);
+
+    // save log to fidlog = fopen([MhDirectoryName '/metropolis.log'],'a');
+    ssFName.str("");
+    ssFName << resultsFileStem << DIRECTORY_SEPARATOR << "metropolis" << DIRECTORY_SEPARATOR << "metropolis.log";
+    mhFName = ssFName.str();
+    fidlog = fopen(mhFName.c_str(), "a");
+    fprintf(fidlog, "\n");
+    fprintf(fidlog, "%% Mh%dBlck%lu ( %s %s )\n", (int) f.newFile, b, __DATE__, __TIME__);
+    fprintf(fidlog, " \n");
+    fprintf(fidlog, "  Number of simulations.: %lu \n", f.size); // (length(logpo2)) ');
+    fprintf(fidlog, "  Acceptation rate......: %f \n", f.jsux);
+    fprintf(fidlog, "  Posterior mean........:\n");
+    for (size_t i = 0; i < npar; ++i)
+      {
+        VectorView mhpdColVw = mat::get_col(mhParamDraws, i);
+        fprintf(fidlog, "    params: %lu : %f \n", i+1, vec::meanSumMinMax(dsum, dmin, dmax, mhpdColVw));
+        MinMax(i, iMin) = dmin;
+        MinMax(i, iMax) = dmax;
+      } // end
+    fprintf(fidlog, "    log2po: %f \n", vec::meanSumMinMax(dsum, dmin, dmax, mhLogPostDens));
+    fprintf(fidlog, "  Minimum value.........:\n");;
+    for (size_t i = 0; i < npar; ++i)
+      fprintf(fidlog, "    params: %lu : %f \n", i+1, MinMax(i, iMin));
+    fprintf(fidlog, "    log2po: %f \n", dmin);
+    fprintf(fidlog, "  Maximum value.........:\n");
+    for (size_t i = 0; i < npar; ++i)
+      fprintf(fidlog, "    params: %lu : %f \n", i+1, MinMax(i, iMax));
+    fprintf(fidlog, "    log2po: %f \n", dmax);
+    fprintf(fidlog, " \n");
+    fclose(fidlog);
+    return true;
+  };
+};
+
+//! Error code of sampleMHMC when the MH files could not be saved, raised as an error by mexFunction
+const int MH_FILE_WRITE_ERROR = -4;
+
+//! Waits for the writer to save the files it was given; returns 0, or MH_FILE_WRITE_ERROR after reporting its failure
+int
+waitForWriter(BackgroundWorker &writerThread, MHFileWriter &writer)
+{
+  try
+    {
+      writerThread.wait();
+    }
+  catch (const TSException &tse)
+    {
+      mexPrintf(" TSException Exception in MH file writer: %s \n", (tse.getMessage()).c_str());
+      return MH_FILE_WRITE_ERROR;
+    }
+  if (!writer.errorMessage.empty())
+    {
+      mexPrintf("%s", writer.errorMessage.c_str());
+      return MH_FILE_WRITE_ERROR;
+    }
+  return 0;
+}
+
+int
+sampleMHMC(std::vector<MHChain *> &chains, ThreadPool &pool, const MatrixConstView &data,
+           size_t presampleStart, const VectorConstView &nruns, size_t fblock, size_t nBlocks,
+           EstimatedParametersDescription &epd, const std::string &resultsFileStem,
+           size_t console_mode, size_t load_mh_file)
+{
   int iret = 0; // return value
-  std::vector<size_t> OpenOldFile(nBlocks, 0);
-  size_t jloop = 0, irun, j; // counters
-  double dsum, dmax, dmin, sux = 0, jsux = 0;
+  bool running;
   std::string mhFName;
   std::stringstream ssFName;
 #if defined MATLAB_MEX_FILE
   MATFile *drawmat; // MCMC draws output file pointer
-  int matfStatus;
 #else   //  OCTAVE_MEX_FILE e.t.c.
-# if MATIO_MAJOR_VERSION > 1 || (MATIO_MAJOR_VERSION == 1 && MATIO_MINOR_VERSION >= 5)
-  size_t dims[2];
-  const matio_compression compression = MAT_COMPRESSION_NONE;
-# else
-  int dims[2];
-  const int compression = COMPRESSION_NONE;
-# endif
   mat_t *drawmat;
   matvar_t *matvar;
-  int matfStatus;
 #endif
-  FILE *fidlog;  // log file
-  size_t npar = estParams.getSize();
-  Matrix MinMax(npar, 2);
+  size_t npar = chains[0]->startParams.getSize();
+  MHChainTask task(chains, npar, data, presampleStart, epd);
+  // The files of a round are saved while the chains run the next one
+  MHFileWriter writer(resultsFileStem, npar);
+  BackgroundWorker writerThread;
 
   const mxArray *InitSizeArrayPtr = mexGetVariablePtr("caller", "InitSizeArray");
   if (InitSizeArrayPtr == NULL)
@@ -181,7 +542,6 @@ sampleMHMC(LogPosteriorDensity &lpd, RandomWalkMetropolisHastings &rwmh,
 
   const mxArray *blockStartParamsPtr = mexGetVariable("caller", "ix2");
   MatrixView blockStartParamsMxVw(mxGetPr(blockStartParamsPtr), nBlocks, npar, nBlocks);
-  Vector startParams(npar);
 
   const mxArray *mxFirstLogLikPtr = mexGetVariable("caller", "ilogpo2");
   VectorView FirstLogLiK(mxGetPr(mxFirstLogLikPtr), nBlocks, 1);
@@ -208,10 +568,6 @@ sampleMHMC(LogPosteriorDensity &lpd, RandomWalkMetropolisHastings &rwmh,
   mxArray *mxLastLogLikPtr = mxGetField(record, 0, "LastLogLiK");
   VectorView LastLogLiK(mxGetPr(mxLastLogLikPtr), nBlocks, 1);
 
-  mxArray *mxMhLogPostDensPtr = 0;
-  mxArray *mxMhParamDrawsPtr = 0;
-  size_t currInitSizeArray = 0;
-
 #if defined MATLAB_MEX_FILE
   // Waitbar
   mxArray *waitBarRhs[3], *waitBarLhs[1];
@@ -233,81 +589,42 @@ sampleMHMC(LogPosteriorDensity &lpd, RandomWalkMetropolisHastings &rwmh,
     }
 #endif
 
-  for (size_t b = fblock; b <= nBlocks; ++b)
+  // Reload the interim draws files of the chains which are resumed
+  for (size_t k = 0; k < chains.size(); ++k)
     {
-      jloop = jloop+1;
-
-#if defined MATLAB_MEX_FILE
-      if ((load_mh_file != 0)  && (fline(b) > 1) && OpenOldFile[b])
+      MHChain &c = *chains[k];
+      const size_t b = c.b;
+      if ((load_mh_file != 0)  && (fline(b-1) > 1))
         {
           //  load(['./' MhDirectoryName '/' ModelName '_mh' int2str(NewFile(b)) '_blck' int2str(b) '.mat'])
           ssFName.clear();
           ssFName.str("");
           ssFName << resultsFileStem << DIRECTORY_SEPARATOR << "metropolis" << DIRECTORY_SEPARATOR << resultsFileStem << "_mh" << (size_t) NewFileVw(b-1) << "_blck" << b << ".mat";
           mhFName = ssFName.str();
+#if defined MATLAB_MEX_FILE
           drawmat = matOpen(mhFName.c_str(), "r");
           mexPrintf("MHMCMC: Using interim partial draws file %s \n", mhFName.c_str());
           if (drawmat == 0)
             {
-              fline(b) = 1;
+              fline(b-1) = 1;
               mexPrintf("Error in MH: Can not open old draws Mat file for reading:  %s \n  \
                   Starting a new file instead! \n", mhFName.c_str());
             }
           else
             {
-              currInitSizeArray = (size_t) InitSizeArray(b-1);
-              mxMhParamDrawsPtr = matGetVariable(drawmat, "x2");
-              mxMhLogPostDensPtr = matGetVariable(drawmat, "logpo2");
+              c.currInitSizeArray = (size_t) InitSizeArray(b-1);
+              c.mxMhParamDrawsPtr = matGetVariable(drawmat, "x2");
+              c.mxMhLogPostDensPtr = matGetVariable(drawmat, "logpo2");
               matClose(drawmat);
-              OpenOldFile[b] = 1;
+              c.openOldFile = true;
             }
-        } // end if
-      if (console_mode == 0)
-        {
-          ssbarTitle.clear();
-          ssbarTitle.str("");
-          ssbarTitle << "Please wait... Metropolis-Hastings  " << b << "/" << nBlocks << "  ...";
-          barTitle = ssbarTitle.str();
-          waitBarRhs[2] = mxCreateString(barTitle.c_str());
-          //strcpy( *mxGetPr(waitBarRhs[1]), mhFName.c_str());
-          *mxGetPr(waitBarRhs[0]) = (double) 0.0;
-          mexCallMATLAB(0, NULL, 3, waitBarRhs, "waitbar");
-          mxDestroyArray(waitBarRhs[2]);
-        }
 #else //if defined OCTAVE_MEX_FILE
-      if ((load_mh_file != 0)  && (fline(b) > 1) && OpenOldFile[b])
-        {
-          //  load(['./' MhDirectoryName '/' ModelName '_mh' int2str(NewFile(b)) '_blck' int2str(b) '.mat'])
-          if ((currInitSizeArray != (size_t) InitSizeArray(b-1)) &&   OpenOldFile[b] != 1)
-            {
-              // new or different size result arrays/matrices
-              currInitSizeArray = (size_t) InitSizeArray(b-1);
-              if (mxMhLogPostDensPtr)
-                mxDestroyArray(mxMhLogPostDensPtr);                                                                                                                                                                // log post density array
-              mxMhLogPostDensPtr = mxCreateDoubleMatrix(currInitSizeArray, 1, mxREAL);
-              if (mxMhLogPostDensPtr == NULL)
-                {
-                  mexPrintf("Metropolis-Hastings mxMhLogPostDensPtr Initialisation failed!\n");
-                  return (-1);
-                }
-              if (mxMhParamDrawsPtr)
-                mxDestroyArray(mxMhParamDrawsPtr);                                                                                                                                                             // accepted MCMC MH draws
-              mxMhParamDrawsPtr =  mxCreateDoubleMatrix(currInitSizeArray, npar,  mxREAL);
-              if (mxMhParamDrawsPtr == NULL)
-                {
-                  mexPrintf("Metropolis-Hastings mxMhParamDrawsPtr Initialisation failed!\n");
-                  return (-1);
-                }
-            }
-
-          ssFName.clear();
-          ssFName.str("");
-          ssFName << resultsFileStem << DIRECTORY_SEPARATOR << "metropolis" << DIRECTORY_SEPARATOR << resultsFileStem << "_mh" << (size_t) NewFileVw(b-1) << "_blck" << b << ".mat";
-          mhFName = ssFName.str();
+          if (!allocateDraws(c, (size_t) InitSizeArray(b-1), npar))
+            return (-1);
           drawmat = Mat_Open(mhFName.c_str(), MAT_ACC_RDONLY);
           if (drawmat == NULL)
             {
-              fline(b) = 1;
+              fline(b-1) = 1;
               mexPrintf("Error in MH: Can not open old draws Mat file for reading:  %s \n  \
                   Starting a new file instead! \n", mhFName.c_str());
             }
@@ -319,7 +636,7 @@ sampleMHMC(LogPosteriorDensity &lpd, RandomWalkMetropolisHastings &rwmh,
               matvar = Mat_VarReadInfo(drawmat, (char *) "x2");
               if (matvar == NULL)
                 {
-                  fline(b) = 1;
+                  fline(b-1) = 1;
                   mexPrintf("Error in MH: Can not read old draws Mat file for reading:  %s \n  \
                       Starting a new file instead! \n", mhFName.c_str());
                 }
@@ -328,10 +645,10 @@ sampleMHMC(LogPosteriorDensity &lpd, RandomWalkMetropolisHastings &rwmh,
                   // GetVariable(drawmat, "x2");
                   edge[0] = matvar->dims[0];
                   edge[1] = matvar->dims[1];
-                  err = Mat_VarReadData(drawmat, matvar, mxGetPr(mxMhParamDrawsPtr), start, stride, edge);
+                  err = Mat_VarReadData(drawmat, matvar, mxGetPr(c.mxMhParamDrawsPtr), start, stride, edge);
                   if (err)
                     {
-                      fline(b) = 1;
+                      fline(b-1) = 1;
                       mexPrintf("Error in MH: Can not retreive old draws from Mat file:  %s \n  \
                           Starting a new file instead! \n", mhFName.c_str());
                     }
@@ -341,7 +658,7 @@ sampleMHMC(LogPosteriorDensity &lpd, RandomWalkMetropolisHastings &rwmh,
               matvar = Mat_VarReadInfo(drawmat, (char *) "logpo2");
               if (matvar == NULL)
                 {
-                  fline(b) = 1;
+                  fline(b-1) = 1;
                   mexPrintf("Error in MH: Can not read old logPos Mat file for reading:  %s \n  \
                       Starting a new file instead! \n", mhFName.c_str());
                 }
@@ -350,244 +667,145 @@ sampleMHMC(LogPosteriorDensity &lpd, RandomWalkMetropolisHastings &rwmh,
                   // GetVariable(drawmat, "x2");
                   edge[0] = matvar->dims[0];
                   edge[1] = matvar->dims[1];
-                  err = Mat_VarReadData(drawmat, matvar, mxGetPr(mxMhLogPostDensPtr), start, stride, edge);
+                  err = Mat_VarReadData(drawmat, matvar, mxGetPr(c.mxMhLogPostDensPtr), start, stride, edge);
                   if (err)
                     {
-                      fline(b) = 1;
+                      fline(b-1) = 1;
                       mexPrintf("Error in MH: Can not retreive old logPos from Mat file:  %s \n  \
                           Starting a new file instead! \n", mhFName.c_str());
                     }
                   Mat_VarFree(matvar);
                 }
               Mat_Close(drawmat);
-              OpenOldFile[b] = 1;
+              c.openOldFile = true;
             }
-        } // end if
-
 #endif
+        } // end if
+      c.irun = (size_t) fline(b-1);
+      // A resumed chain continues its proposal stream after the draws of the earlier sessions
+      if (load_mh_file != 0)
+        c.pdd->setPosition(RandomWalkMetropolisHastings::resumePosition((size_t) NewFileVw(b-1), c.irun, MAX_nruns));
+    }
 
-      VectorView LastParametersRow = mat::get_row(LastParameters, b-1);
-
-      sux = 0.0;
-      jsux = 0;
-      irun = (size_t) fline(b-1);
-      j = 0; //1;
-      while (j < nruns(b-1))
+  // The chains run concurrently, one file at a time: after each round, the
+  // main thread reports the progress and updates the records, in the order of
+  // the blocks, and hands copies of the completed files to the writer; the
+  // chains then fill their next files while those copies are saved
+  do
+    {
+      for (size_t k = 0; k < chains.size(); ++k)
         {
-          if ((currInitSizeArray != (size_t) InitSizeArray(b-1)) &&   OpenOldFile[b] != 1)
-            {
-              // new or different size result arrays/matrices
-              currInitSizeArray = (size_t) InitSizeArray(b-1);
-              if (mxMhLogPostDensPtr)
-                mxDestroyArray(mxMhLogPostDensPtr);                                                                                                                                                                // log post density array
-              mxMhLogPostDensPtr = mxCreateDoubleMatrix(currInitSizeArray, 1, mxREAL);
-              if (mxMhLogPostDensPtr == NULL)
-                {
-                  mexPrintf("Metropolis-Hastings mxMhLogPostDensPtr Initialisation failed!\n");
-                  return (-1);
-                }
-              if (mxMhParamDrawsPtr)
-                mxDestroyArray(mxMhParamDrawsPtr);                                                                                                                                                             // accepted MCMC MH draws
-              mxMhParamDrawsPtr =  mxCreateDoubleMatrix(currInitSizeArray, npar,  mxREAL);
-              if (mxMhParamDrawsPtr == NULL)
-                {
-                  mexPrintf("Metropolis-Hastings mxMhParamDrawsPtr Initialisation failed!\n");
-                  return (-1);
-                }
-            }
-          startParams = LastParametersRow;
-          VectorView mhLogPostDens(mxGetPr(mxMhLogPostDensPtr), currInitSizeArray, (size_t) 1);
-          MatrixView mhParamDraws(mxGetPr(mxMhParamDrawsPtr), currInitSizeArray, npar, currInitSizeArray);
-          try
-            {
-              jsux = rwmh.compute(mhLogPostDens, mhParamDraws, steadyState, startParams, deepParams, data, Q, H,
-                                  presampleStart, irun, currInitSizeArray, lpd, pdd, epd);
-              irun = currInitSizeArray;
-              sux += jsux*currInitSizeArray;
-              j += currInitSizeArray; //j=j+1;
-            }
-          catch (const TSException &tse)
-            {
-              iret = -100;
-              mexPrintf(" TSException Exception in RandomWalkMH dynamic_dll: %s \n", (tse.getMessage()).c_str());
-              goto cleanup;
-            }
-          catch (const DecisionRules::BlanchardKahnException &bke)
+          MHChain &c = *chains[k];
+          const size_t b = c.b;
+          c.active = c.j < nruns(b-1);
+          if (!c.active)
+            continue;
+          if (!c.openOldFile && !allocateDraws(c, (size_t) InitSizeArray(b-1), npar))
             {
-              iret = -90;
-              mexPrintf(" Too many Blanchard-Kahn Exceptions in RandomWalkMH : n_fwrd_vars %d n_explosive_eigenvals %d \n", bke.n_fwrd_vars, bke.n_explosive_eigenvals);
+              iret = -1;
               goto cleanup;
             }
-          catch (const GeneralizedSchurDecomposition::GSDException &gsde)
-            {
-              iret = -80;
-              mexPrintf(" GeneralizedSchurDecomposition Exception in RandomWalkMH: info %d, n %d  \n", gsde.info, gsde.n);
-              goto cleanup;
-            }
-          catch (const LUSolver::LUException &lue)
-            {
-              iret = -70;
-              mexPrintf(" LU Exception in RandomWalkMH : info %d \n", lue.info);
-              goto cleanup;
-            }
-          catch (const VDVEigDecomposition::VDVEigException &vdve)
-            {
-              iret = -60;
-              mexPrintf(" VDV Eig Exception in RandomWalkMH : %s ,  info: %d\n", vdve.message.c_str(), vdve.info);
-              goto cleanup;
-            }
-          catch (const DiscLyapFast::DLPException &dlpe)
-            {
-              iret = -50;
-              mexPrintf(" Lyapunov solver Exception in RandomWalkMH : %s ,  info: %d\n", dlpe.message.c_str(), dlpe.info);
-              goto cleanup;
-            }
-          catch (const std::runtime_error &re)
-            {
-              iret = -3;
-              mexPrintf(" Runtime Error Exception in RandomWalkMH: %s \n", re.what());
-              goto cleanup;
-            }
-          catch (const std::exception &e)
-            {
-              iret = -2;
-              mexPrintf(" Standard System Exception in RandomWalkMH: %s \n", e.what());
-              goto cleanup;
-            }
-          catch (...)
+          c.mhLogPostDensData = mxGetPr(c.mxMhLogPostDensPtr);
+          c.mhParamDrawsData = mxGetPr(c.mxMhParamDrawsPtr);
+          c.startParams = mat::get_row(LastParameters, b-1);
+        }
+
+      try
+        {
+          pool.run(task, chains.size());
+        }
+      catch (const TSException &tse)
+        {
+          iret = -100;
+          mexPrintf(" TSException Exception in RandomWalkMH thread pool: %s \n", (tse.getMessage()).c_str());
+          goto cleanup;
+        }
+
+      // The files of the previous round must be saved before the writer is
+      // given those of this round
+      iret = waitForWriter(writerThread, writer);
+      if (iret != 0)
+        goto cleanup;
+      writer.files.clear();
+
+      running = false;
+      for (size_t k = 0; k < chains.size(); ++k)
+        {
+          MHChain &c = *chains[k];
+          const size_t b = c.b;
+          if (!c.active)
+            continue;
+          if (c.iret != 0)
             {
-              iret = -1000;
-              mexPrintf(" Unknown unhandled Exception in RandomWalkMH! %s \n");
-              goto cleanup;
+              // The files completed by the other chains are still saved below
+              if (iret == 0)
+                iret = c.iret;
+              mexPrintf("%s", c.errorMessage.c_str());
+              continue;
             }
+          c.openOldFile = false;
+          VectorView mhLogPostDens(mxGetPr(c.mxMhLogPostDensPtr), c.currInitSizeArray, (size_t) 1);
+          MatrixView mhParamDraws(mxGetPr(c.mxMhParamDrawsPtr), c.currInitSizeArray, npar, c.currInitSizeArray);
 
 #if defined MATLAB_MEX_FILE
           if (console_mode)
-            mexPrintf("   MH: Computing Metropolis-Hastings (chain %d/%d): %3.f \b%% done, acceptance rate: %3.f \b%%\r", b, nBlocks, 100 * j/nruns(b-1), 100 * sux / j);
+            mexPrintf("   MH: Computing Metropolis-Hastings (chain %d/%d): %3.f \b%% done, acceptance rate: %3.f \b%%\r", b, nBlocks, 100 * c.j/nruns(b-1), 100 * c.sux / c.j);
           else
             {
               // Waitbar
               ssbarTitle.clear();
               ssbarTitle.str("");
-              ssbarTitle << "Metropolis-Hastings : " << b << "/" << nBlocks << " Acceptance: " << 100 * sux/j << "%";
+              ssbarTitle << "Metropolis-Hastings : " << b << "/" << nBlocks << " Acceptance: " << 100 * c.sux/c.j << "%";
               barTitle = ssbarTitle.str();
               waitBarRhs[2] = mxCreateString(barTitle.c_str());
-              *mxGetPr(waitBarRhs[0]) = j / nruns(b-1);
+              *mxGetPr(waitBarRhs[0]) = c.j / nruns(b-1);
               mexCallMATLAB(0, NULL, 3, waitBarRhs, "waitbar");
               mxDestroyArray(waitBarRhs[2]);
 
             }
-
-          // % Now I save the simulations
-          // save draw  2 mat file ([MhDirectoryName '/' ModelName '_mh' int2str(NewFile(b)) '_blck' int2str(b) '.mat'],'x2','logpo2');
-          ssFName.clear();
-          ssFName.str("");
-          ssFName << resultsFileStem << DIRECTORY_SEPARATOR << "metropolis" << DIRECTORY_SEPARATOR << resultsFileStem << "_mh" << (size_t) NewFileVw(b-1) << "_blck" << b << ".mat";
-          mhFName = ssFName.str();
-          drawmat = matOpen(mhFName.c_str(), "w");
-          if (drawmat == 0)
-            {
-              mexPrintf("Error in MH: Can not open draws Mat file for writing:  %s \n", mhFName.c_str());
-              exit(1);
-            }
-          matfStatus = matPutVariable(drawmat, "x2", mxMhParamDrawsPtr);
-          if (matfStatus)
-            {
-              mexPrintf("Error in MH: Can not use draws Mat file for writing:  %s \n", mhFName.c_str());
-              exit(1);
-            }
-          matfStatus = matPutVariable(drawmat, "logpo2", mxMhLogPostDensPtr);
-          if (matfStatus)
-            {
-              mexPrintf("Error in MH: Can not usee draws Mat file for writing:  %s \n", mhFName.c_str());
-              exit(1);
-            }
-          matClose(drawmat);
 #else
-
-          printf("   MH: Computing Metropolis-Hastings (chain %ld/%ld): %3.f \b%% done, acceptance rate: %3.f \b%%\r", b, nBlocks, 100 * j/nruns(b-1), 100 * sux / j);
-          // % Now I save the simulations
-          // save draw  2 mat file ([MhDirectoryName '/' ModelName '_mh' int2str(NewFile(b)) '_blck' int2str(b) '.mat'],'x2','logpo2');
-          ssFName.clear();
-          ssFName.str("");
-          ssFName << resultsFileStem << DIRECTORY_SEPARATOR << "metropolis" << DIRECTORY_SEPARATOR << resultsFileStem << "_mh" << (size_t) NewFileVw(b-1) << "_blck" << b << ".mat";
-          mhFName = ssFName.str();
-
-          drawmat = Mat_Create(mhFName.c_str(), NULL);
-          if (drawmat == 0)
-            {
-              mexPrintf("Error in MH: Can not open draws Mat file for writing:  %s \n", mhFName.c_str());
-              exit(1);
-            }
-          dims[0] = currInitSizeArray;
-          dims[1] = npar;
-          matvar = Mat_VarCreate("x2", MAT_C_DOUBLE, MAT_T_DOUBLE, 2, dims, mxGetPr(mxMhParamDrawsPtr), 0);
-          matfStatus = Mat_VarWrite(drawmat, matvar, compression);
-          Mat_VarFree(matvar);
-          if (matfStatus)
-            {
-              mexPrintf("Error in MH: Can not use draws Mat file for writing:  %s \n", mhFName.c_str());
-              exit(1);
-            }
-          //matfStatus = matPutVariable(drawmat, "logpo2", mxMhLogPostDensPtr);
-          dims[1] = 1;
-          matvar = Mat_VarCreate("logpo2", MAT_C_DOUBLE, MAT_T_DOUBLE, 2, dims, mxGetPr(mxMhLogPostDensPtr), 0);
-          matfStatus = Mat_VarWrite(drawmat, matvar, compression);
-          Mat_VarFree(matvar);
-          if (matfStatus)
-            {
-              mexPrintf("Error in MH: Can not usee draws Mat file for writing:  %s \n", mhFName.c_str());
-              exit(1);
-            }
-          Mat_Close(drawmat);
+          printf("   MH: Computing Metropolis-Hastings (chain %ld/%ld): %3.f \b%% done, acceptance rate: %3.f \b%%\r", b, nBlocks, 100 * c.j/nruns(b-1), 100 * c.sux / c.j);
 #endif
 
-          // save log to fidlog = fopen([MhDirectoryName '/metropolis.log'],'a');
-          ssFName.str("");
-          ssFName << resultsFileStem << DIRECTORY_SEPARATOR << "metropolis" << DIRECTORY_SEPARATOR << "metropolis.log";
-          mhFName = ssFName.str();
-          fidlog = fopen(mhFName.c_str(), "a");
-          fprintf(fidlog, "\n");
-          fprintf(fidlog, "%% Mh%dBlck%lu ( %s %s )\n", (int) NewFileVw(b-1), b, __DATE__, __TIME__);
-          fprintf(fidlog, " \n");
-          fprintf(fidlog, "  Number of simulations.: %lu \n", currInitSizeArray); // (length(logpo2)) ');
-          fprintf(fidlog, "  Acceptation rate......: %f \n", jsux);
-          fprintf(fidlog, "  Posterior mean........:\n");
-          for (size_t i = 0; i < npar; ++i)
-            {
-              VectorView mhpdColVw = mat::get_col(mhParamDraws, i);
-              fprintf(fidlog, "    params: %lu : %f \n", i+1, vec::meanSumMinMax(dsum, dmin, dmax, mhpdColVw));
-              MinMax(i, iMin) = dmin;
-              MinMax(i, iMax) = dmax;
-            } // end
-          fprintf(fidlog, "    log2po: %f \n", vec::meanSumMinMax(dsum, dmin, dmax, mhLogPostDens));
-          fprintf(fidlog, "  Minimum value.........:\n");;
-          for (size_t i = 0; i < npar; ++i)
-            fprintf(fidlog, "    params: %lu : %f \n", i+1, MinMax(i, iMin));
-          fprintf(fidlog, "    log2po: %f \n", dmin);
-          fprintf(fidlog, "  Maximum value.........:\n");
-          for (size_t i = 0; i < npar; ++i)
-            fprintf(fidlog, "    params: %lu : %f \n", i+1, MinMax(i, iMax));
-          fprintf(fidlog, "    log2po: %f \n", dmax);
-          fprintf(fidlog, " \n");
-          fclose(fidlog);
-
-          jsux = 0;
-          LastParametersRow = mat::get_row(mhParamDraws, currInitSizeArray-1); //x2(end,:);
-          LastLogLiK(b-1) = mhLogPostDens(currInitSizeArray-1); //logpo2(end);
-          InitSizeArray(b-1) = std::min((size_t) nruns(b-1)-j, MAX_nruns);
+          writer.files.push_back(MHFileWriter::File());
+          MHFileWriter::File &file = writer.files.back();
+          file.b = b;
+          file.newFile = (size_t) NewFileVw(b-1);
+          file.size = c.currInitSizeArray;
+          file.jsux = c.jsux;
+          file.logPostDens.assign(mhLogPostDens.getData(), mhLogPostDens.getData() + c.currInitSizeArray);
+          file.paramDraws.assign(mhParamDraws.getData(), mhParamDraws.getData() + c.currInitSizeArray*npar);
+
+          c.jsux = 0;
+          VectorView LastParametersRow = mat::get_row(LastParameters, b-1);
+          LastParametersRow = mat::get_row(mhParamDraws, c.currInitSizeArray-1); //x2(end,:);
+          LastLogLiK(b-1) = mhLogPostDens(c.currInitSizeArray-1); //logpo2(end);
+          InitSizeArray(b-1) = std::min((size_t) nruns(b-1)-c.j, MAX_nruns);
           // initialization of next file if necessary
           if (InitSizeArray(b-1))
             {
               NewFileVw(b-1)++; // = NewFile(b-1) + 1;
-              irun = 1;
+              c.irun = 1;
             } // end
-          //irun++;
-        } // end  while % End of the simulations for one mh-block.
-      //record.
-      AcceptationRates(b-1) = sux/j;
-      OpenOldFile[b] = 0;
-    } // end % End of the loop over the mh-blocks.
+          if (c.j < nruns(b-1))
+            running = true;
+        }
+      writerThread.submit(writer);
+      if (iret != 0)
+        {
+          // A chain failed: stop once the files of the others are saved
+          waitForWriter(writerThread, writer);
+          goto cleanup;
+        }
+    }
+  while (running);  // End of the simulations of the mh-blocks.
+  iret = waitForWriter(writerThread, writer);
+  if (iret != 0)
+    goto cleanup;
+
+  //record.
+  for (size_t k = 0; k < chains.size(); ++k)
+    AcceptationRates(chains[k]->b-1) = chains[k]->sux/chains[k]->j;
 
   if (mexPutVariable("caller", "record_AcceptationRates", AcceptationRatesPtr))
     mexPrintf("MH Warning: due to error record_AcceptationRates is NOT set !! \n");
@@ -602,15 +820,25 @@ sampleMHMC(LogPosteriorDensity &lpd, RandomWalkMetropolisHastings &rwmh,
   if (mexPutVariable("caller", "NewFile", NewFileArrayPtr))
     mexPrintf("MH Warning: due to error NewFile is NOT set !! \n");
 
+  {
+    LogPosteriorDensity::Counters counters = { 0, 0, 0.0, 0.0 };
+    for (size_t k = 0; k < chains.size(); ++k)
+      {
+        const LogPosteriorDensity::Counters &chainCounters = chains[k]->lpd->getCounters();
+        counters.evaluations += chainCounters.evaluations;
+        counters.priorShortCircuits += chainCounters.priorShortCircuits;
+        counters.priorTime += chainCounters.priorTime;
+        counters.likelihoodTime += chainCounters.likelihoodTime;
+      }
+    mexPrintf("MH: %lu posterior evaluations in %lu chain(s) on %lu thread(s), %lu stopped by a zero prior density; time in prior %.3fs, in likelihood %.3fs\n",
+              (unsigned long) counters.evaluations, (unsigned long) chains.size(), (unsigned long) pool.getNumWorkers(),
+              (unsigned long) counters.priorShortCircuits, counters.priorTime, counters.likelihoodTime);
+  }
+
   // Cleanup
   mexPrintf("MH Cleanup !! \n");
 
  cleanup:
-  if (mxMhLogPostDensPtr)
-    mxDestroyArray(mxMhLogPostDensPtr);                                                                                      // delete log post density array
-  if (mxMhParamDrawsPtr)
-    mxDestroyArray(mxMhParamDrawsPtr);                                                                                     // delete accepted MCMC MH draws
-
 #ifdef MATLAB_MEX_FILE
   // Waitbar
   if (console_mode == 0)
@@ -627,7 +855,7 @@ sampleMHMC(LogPosteriorDensity &lpd, RandomWalkMetropolisHastings &rwmh,
 
   // return error code or last line run in the last MH block sub-array
   if (iret == 0)
-    iret = (int) irun;
+    iret = (int) chains.back()->irun;
   return iret;
 
 }
@@ -718,22 +946,111 @@ logMCMCposterior(VectorConstView &estParams, const MatrixConstView &data,
 
   bool noconstant = (bool) *mxGetPr(mxGetField(options_, 0, "noconstant"));
 
-  // Allocate LogPosteriorDensity object
-  LogPosteriorDensity lpd(basename, epd, n_endo, n_exo, zeta_fwrd, zeta_back, zeta_mixed, zeta_static,
-                          qz_criterium, varobs, riccati_tol, lyapunov_tol, noconstant);
+  // The posterior objects of the chains live long enough for the analysis of the jacobian structure to pay off
+  ModelSolution::Options modelSolutionOptions;
+  modelSolutionOptions.analyzeJacobianStructure = true;
+  // As in Dynare, the closed form of the steady state is checked unless options_.nocheck is set
+  const mxArray *nocheck_mx = mxGetField(options_, 0, "nocheck");
+  modelSolutionOptions.checkAnalyticSteadyState = nocheck_mx == NULL || *mxGetPr(nocheck_mx) == 0;
+  // Optional restarts of the steady state solver when it fails, e.g. options_.steady_state_recovery_starts = 16
+  const mxArray *recovery_mx = mxGetField(options_, 0, "steady_state_recovery_starts");
+  if (recovery_mx != NULL && !mxIsEmpty(recovery_mx))
+    modelSolutionOptions.steadyStateRecoveryStarts = (size_t) *mxGetPr(recovery_mx);
 
-  // Construct MHMCMC Sampler
-  RandomWalkMetropolisHastings rwmh(estParams.getSize());
   // Construct GaussianPrior drawDistribution m=0, sd=1
   GaussianPrior drawGaussDist01(0.0, 1.0, -INFINITY, INFINITY, 0.0, 1.0);
   // get Jscale = diag(bayestopt_.jscale);
   const Matrix Jscale(n_estParams);
   const VectorConstView vJscale(mxGetPr(mxGetField(bayestopt_, 0, "jscale")), n_estParams, 1);
-  Proposal pdd(vJscale, D);
+  // Optionally, run the random walk in an unconstrained space, with the
+  // proposal covariance mapped to that space at the starting point
+  ParameterTransform transform(estParamsInfo);
+  const mxArray *unconstrained_mx = mxGetField(options_, 0, "mh_unconstrained");
+  const bool unconstrained = unconstrained_mx != NULL && *mxGetPr(unconstrained_mx) != 0;
+  Vector scale(n_estParams);
+  if (unconstrained)
+    {
+      for (size_t i = 0; i < n_estParams; i++)
+        {
+          double u = transform.toUnconstrained(i, estParams(i));
+          if (!std::isfinite(u))
+            throw LogMHMCMCposteriorMexErrMsgTxtException("Error in logMCMCposterior: with option mh_unconstrained, the initial parameters must be inside the bounds");
+          scale(i) = exp(-transform.logDerivative(i, u));
+        }
+    }
+
+  // Optionally, adapt the proposal covariance and jump scale along the chains
+  std::auto_ptr<Proposal> pdd;
+  const mxArray *adaptive_mx = mxGetField(options_, 0, "mh_adaptive");
+  if (adaptive_mx != NULL && *mxGetPr(adaptive_mx) != 0)
+    {
+      double targetAcceptance = 0.234;
+      const mxArray *target_mx = mxGetField(options_, 0, "mh_adaptive_target");
+      if (target_mx != NULL && !mxIsEmpty(target_mx))
+        targetAcceptance = *mxGetPr(target_mx);
+      pdd.reset(new AdaptiveProposal(vJscale, D, targetAcceptance));
+    }
+  else
+    pdd.reset(new Proposal(vJscale, D));
+  const mxArray *streams_mx = mxGetField(options_, 0, "DynareRandomStreams");
+  if (streams_mx != NULL)
+    {
+      const mxArray *seed_mx = mxGetField(streams_mx, 0, "seed");
+      if (seed_mx != NULL && !mxIsEmpty(seed_mx))
+        pdd->seed((int) *mxGetPr(seed_mx));
+    }
+  if (unconstrained)
+    pdd->rescale(scale);
+
+  // Optional binary trace of all the proposals, e.g. options_.mh_trace_file = 'model/metropolis/trace'.
+  // The traces of a previous run are continued with load_mh_file, and overwritten otherwise
+  std::string tracePrefix;
+  const mxArray *trace_mx = mxGetField(options_, 0, "mh_trace_file");
+  if (trace_mx != NULL && mxIsChar(trace_mx) && !mxIsEmpty(trace_mx))
+    {
+      char *tracePrefix_c = mxArrayToString(trace_mx);
+      tracePrefix = tracePrefix_c;
+      mxFree(tracePrefix_c);
+    }
+
+  // The MH blocks run concurrently, each with its own posterior, sampler,
+  // proposal stream and trace. When there are several threads, each
+  // likelihood is evaluated serially, so as not to oversubscribe the processors
+  const size_t nChains = nBlocks - fblock + 1;
+  ThreadPool pool(std::min(nChains, ThreadPool::defaultNumWorkers()));
+  const size_t nLikelihoodThreads = pool.getNumWorkers() > 1 ? 1 : ThreadPool::defaultNumWorkers();
+  modelSolutionOptions.steadyStateRecoveryThreads = nLikelihoodThreads;
+  MHChains chains;
+  for (size_t b = fblock; b <= nBlocks; ++b)
+    {
+      std::auto_ptr<MHChain> owner(new MHChain(b, n_estParams, steadyState, deepParams, Q, H));
+      chains.push_back(owner.get());
+      MHChain *chain = owner.release();
+      chain->lpd = new LogPosteriorDensity(basename, epd, n_endo, n_exo, zeta_fwrd, zeta_back, zeta_mixed, zeta_static,
+                                           qz_criterium, varobs, riccati_tol, lyapunov_tol, noconstant, nLikelihoodThreads);
+      chain->lpd->setModelSolutionOptions(modelSolutionOptions);
+      chain->rwmh = new RandomWalkMetropolisHastings(n_estParams);
+      if (unconstrained)
+        chain->rwmh->setTransform(&transform);
+      // Each MH block draws from its own stream, from its start unless sampleMHMC resumes the chain
+      chain->pdd = pdd->clone();
+      chain->pdd->setChain(b-1);
+      chain->pdd->setPosition(0);
+      if (!tracePrefix.empty())
+        {
+          chain->traceSink = new BufferedMHTraceSink(tracePrefix, n_estParams, load_mh_file != 0);
+          chain->rwmh->setTraceSink(chain->traceSink);
+        }
+    }
 
   //sample MHMCMC draws and get get last line run in the last MH block sub-array
-  int lastMHblockArrayLine = sampleMHMC(lpd, rwmh, steadyState, estParams, deepParams, data, Q, H, presample,
-                                        nMHruns, fblock, nBlocks, pdd, epd, resultsFileStem, console_mode, load_mh_file);
+  int lastMHblockArrayLine = sampleMHMC(chains, pool, data, presample, nMHruns, fblock, nBlocks,
+                                        epd, resultsFileStem, console_mode, load_mh_file);
+
+  // The model state is left as computed by the last block, as in a serial run
+  steadyState = chains.back()->steadyState;
+  deepParams = chains.back()->deepParams;
+  Q = chains.back()->Q;
 
   // Cleanups
   for (std::vector<EstimatedParameter>::iterator it = estParamsInfo.begin();
@@ -798,6 +1115,8 @@ mexFunction(int nlhs, mxArray *plhs[],
   try
     {
       int lastMHblockArrayLine = logMCMCposterior(estParams, data, fblock, nBlocks, nMHruns, D, steadyState, deepParams, Q, H);
+      if (lastMHblockArrayLine == MH_FILE_WRITE_ERROR)
+        DYN_MEX_FUNC_ERR_MSG_TXT("logMCMCposterior: the MH draws files could not be saved");
       plhs[1] = mxCreateDoubleMatrix(1, 1, mxREAL);
       *mxGetPr(plhs[1]) = (double) lastMHblockArrayLine;
     }
@@ -805,5 +1124,9 @@ mexFunction(int nlhs, mxArray *plhs[],
     {
       DYN_MEX_FUNC_ERR_MSG_TXT(e.getErrMsg());
     }
+  catch (const TSException &e)
+    {
+      DYN_MEX_FUNC_ERR_MSG_TXT(e.getMessage().c_str());
+    }
   plhs[0] = mxCreateDoubleScalar(0);
 }
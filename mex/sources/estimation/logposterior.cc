@@ -190,6 +190,17 @@ logposterior(VEC1 &estParams, const MatrixConstView &data,
   LogPosteriorDensity lpd(basename, epd, n_endo, n_exo, zeta_fwrd, zeta_back, zeta_mixed, zeta_static,
                           qz_criterium, varobs, riccati_tol, lyapunov_tol, noconstant);
 
+  // As in Dynare, the closed form of the steady state is checked unless options_.nocheck is set
+  ModelSolution::Options modelSolutionOptions;
+  const mxArray *nocheck_mx = mxGetField(options_, 0, "nocheck");
+  modelSolutionOptions.checkAnalyticSteadyState = nocheck_mx == NULL || *mxGetPr(nocheck_mx) == 0;
+  // Optional restarts of the steady state solver when it fails, e.g. options_.steady_state_recovery_starts = 16
+  const mxArray *recovery_mx = mxGetField(options_, 0, "steady_state_recovery_starts");
+  if (recovery_mx != NULL && !mxIsEmpty(recovery_mx))
+    modelSolutionOptions.steadyStateRecoveryStarts = (size_t) *mxGetPr(recovery_mx);
+  modelSolutionOptions.steadyStateRecoveryThreads = ThreadPool::defaultNumWorkers();
+  lpd.setModelSolutionOptions(modelSolutionOptions);
+
   // Construct arguments of compute() method
 
   // Compute the posterior
@@ -286,4 +297,8 @@ mexFunction(int nlhs, mxArray *plhs[],
     {
       DYN_MEX_FUNC_ERR_MSG_TXT(e.message.c_str());
     }
+  catch (const TSException &e)
+    {
+      DYN_MEX_FUNC_ERR_MSG_TXT(e.getMessage().c_str());
+    }
 }
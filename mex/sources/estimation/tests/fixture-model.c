@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * A small model used by the tests, compiled into a model kernel (see
+ * dynare_model_kernel.h) and, with -DSTEADY_STATE, into a steady state DLL.
+ *
+ * Endogenous variables: k (purely backward), c (purely forward), y (static)
+ * Exogenous variable: e
+ * Parameters: rho, beta, alpha, kbar, gamma
+ *
+ *   k = kbar + rho*(k(-1)-kbar) + e
+ *   c = beta*c(+1) + (1-beta)*k
+ *   y^3 + gamma*y = k + alpha*c
+ *
+ * When gamma < 0, the last equation can have several solutions, and the
+ * Newton solver gets stuck at the local minima of its squared residual.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "dynare_model_kernel.h"
+
+#define ENDO_NBR 3
+#define EXO_NBR 1
+#define PARAM_NBR 5
+
+#ifndef STEADY_STATE
+
+/* Columns of the jacobian: k(-1), k, c, y, c(+1), e */
+# define DYNAMIC_JACOBIAN_COLS 6
+
+void
+Static(const double *y, const double *x, int nb_row_x, const double *params, double *residual, double *g1, double *v2)
+{
+  double rho = params[0], beta = params[1], alpha = params[2], kbar = params[3], gamma = params[4];
+  double k = y[0], c = y[1], yy = y[2], e = x[0];
+
+  residual[0] = (1-rho)*(k-kbar) - e;
+  residual[1] = (1-beta)*(c-k);
+  residual[2] = yy*yy*yy + gamma*yy - k - alpha*c;
+  if (g1 != NULL)
+    {
+      memset(g1, 0, ENDO_NBR*ENDO_NBR*sizeof(double));
+      g1[0 + 0*ENDO_NBR] = 1-rho;
+      g1[1 + 0*ENDO_NBR] = beta-1;
+      g1[1 + 1*ENDO_NBR] = 1-beta;
+      g1[2 + 0*ENDO_NBR] = -1;
+      g1[2 + 1*ENDO_NBR] = -alpha;
+      g1[2 + 2*ENDO_NBR] = 3*yy*yy + gamma;
+    }
+}
+
+void
+Dynamic(const double *y, const double *x, int nb_row_x, const double *params, const double *steady_state,
+        int it_, double *residual, double *g1, double *g2, double *g3)
+{
+  double rho = params[0], beta = params[1], alpha = params[2], kbar = params[3], gamma = params[4];
+  double k_lag = y[0], k = y[1], c = y[2], yy = y[3], c_lead = y[4], e = x[it_];
+
+  residual[0] = k - kbar - rho*(k_lag-kbar) - e;
+  residual[1] = c - beta*c_lead - (1-beta)*k;
+  residual[2] = yy*yy*yy + gamma*yy - k - alpha*c;
+  if (g1 != NULL)
+    {
+      memset(g1, 0, ENDO_NBR*DYNAMIC_JACOBIAN_COLS*sizeof(double));
+      g1[0 + 0*ENDO_NBR] = -rho;
+      g1[0 + 1*ENDO_NBR] = 1;
+      g1[0 + 5*ENDO_NBR] = -1;
+      g1[1 + 1*ENDO_NBR] = beta-1;
+      g1[1 + 2*ENDO_NBR] = 1;
+      g1[1 + 4*ENDO_NBR] = -beta;
+      g1[2 + 1*ENDO_NBR] = -1;
+      g1[2 + 2*ENDO_NBR] = -alpha;
+      g1[2 + 3*ENDO_NBR] = 3*yy*yy + gamma;
+    }
+}
+
+const dynare_model_kernel_info *
+dynare_model_kernel_get_info(void)
+{
+  static const dynare_model_kernel_info info = {
+    DYNARE_MODEL_KERNEL_ABI_VERSION, ENDO_NBR, EXO_NBR, PARAM_NBR, DYNAMIC_JACOBIAN_COLS, 1,
+    "Static", "Dynamic", NULL, NULL
+  };
+  return &info;
+}
+
+#else
+
+/*
+ * Closed form of the steady state, which only exists when gamma > 0. It
+ * deliberately ignores the exogenous variables, so that it is wrong when they
+ * are not zero.
+ */
+int
+SteadyState(const double *params, const double *x, double *steady_state)
+{
+  double alpha = params[2], kbar = params[3], gamma = params[4];
+  double q, s;
+
+  if (!(gamma > 0))
+    return 1;
+
+  /* Cardano's formula for y^3 + gamma*y - q = 0 */
+  q = (1+alpha)*kbar;
+  s = sqrt(q*q/4 + gamma*gamma*gamma/27);
+  steady_state[0] = kbar;
+  steady_state[1] = kbar;
+  steady_state[2] = cbrt(q/2 + s) + cbrt(q/2 - s);
+  return 0;
+}
+
+#endif
@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// An MH chain on the model of fixture-model.c (fixture_kernel.so), with y
+// observed, run file by file as by logMHMCMCposterior
+
+#if !defined(MHCF_5C2E81A7_93D4_4B6F_A0E3_7F14D9B26C58__INCLUDED_)
+#define MHCF_5C2E81A7_93D4_4B6F_A0E3_7F14D9B26C58__INCLUDED_
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "RandomWalkMetropolisHastings.hh"
+
+static const size_t n_endo = 3, n_exo = 1, n_params = 5, n_periods = 40, npar = 2, drawsPerFile = 6;
+
+// Estimated parameters, data and proposal covariance
+struct ChainFixture
+{
+  GaussianPrior sdPrior, rhoPrior;
+  std::vector<EstimationSubsample> subsamples;
+  std::vector<EstimatedParameter> estParamsInfo;
+  EstimatedParametersDescription epd;
+  Matrix data;
+  Vector jscale;
+  Matrix cov;
+
+  ChainFixture() :
+    sdPrior(0.1, 0.1, -INFINITY, INFINITY, 0.0, 1.0), rhoPrior(0.8, 0.1, -INFINITY, INFINITY, 0.0, 1.0),
+    subsamples(1, EstimationSubsample(0, n_periods-1)), estParamsInfo(makeEstParamsInfo(sdPrior, rhoPrior)),
+    epd(subsamples, estParamsInfo), data(1, n_periods), jscale(npar), cov(npar)
+  {
+    for (size_t t = 0; t < n_periods; t++)
+      data(0, t) = 0.1*sin(0.3*t);
+    jscale.setAll(0.5);
+    cov.setAll(0.0);
+    cov(0, 0) = 1e-4;
+    cov(1, 1) = 1e-2;
+  };
+
+  static std::vector<EstimatedParameter>
+  makeEstParamsInfo(GaussianPrior &sdPrior, GaussianPrior &rhoPrior)
+  {
+    std::vector<size_t> all(1, 0);
+    std::vector<EstimatedParameter> info;
+    info.push_back(EstimatedParameter(EstimatedParameter::shock_SD, 0, 0, all, 0, 10, &sdPrior));
+    info.push_back(EstimatedParameter(EstimatedParameter::deepPar, 0, 0, all, 0, 1, &rhoPrior));
+    return info;
+  };
+};
+
+// Objects of a MEX call, which all start afresh
+struct Session
+{
+  ChainFixture &fixture;
+  LogPosteriorDensity lpd;
+  RandomWalkMetropolisHastings rwmh;
+  Proposal proposal;
+  Vector steadyState, deepParams;
+  Matrix Q, H;
+  double currentLogPost;
+
+  Session(ChainFixture &fixture_arg) :
+    fixture(fixture_arg),
+    lpd("fixture", fixture.epd, n_endo, n_exo, std::vector<size_t>(1, 1), std::vector<size_t>(1, 0), std::vector<size_t>(),
+        std::vector<size_t>(1, 2), 1.0+1.0e-9, std::vector<size_t>(1, 2), 1e-6, 1e-15, false, 1),
+    rwmh(npar), proposal(VectorConstView(fixture.jscale.getData(), npar, 1), MatrixConstView(fixture.cov.getData(), npar, npar, npar)),
+    steadyState(n_endo), deepParams(n_params), Q(n_exo), H(1), currentLogPost(std::numeric_limits<double>::quiet_NaN())
+  {
+    const double params[] = { 0.9, 0.99, 0.5, 1.0, 1.0 }; // rho, beta, alpha, kbar, gamma
+    deepParams = VectorConstView(params, n_params, 1);
+    steadyState.setAll(1.0);
+    Q.setAll(0.0);
+    H.setAll(0.0);
+    proposal.seed(0);
+    proposal.setChain(0);
+  };
+
+  // Fills the lines [fline, lline] (from 1) of file newFile of the chain, starting from the draw before them
+  void
+  run(Matrix &draws, size_t newFile, size_t fline, size_t lline)
+  {
+    size_t first = (newFile-1)*drawsPerFile;
+    Vector start(npar);
+    if (first + fline == 1)
+      {
+        start(0) = 0.1;
+        start(1) = 0.8;
+      }
+    else
+      start = mat::get_row(draws, first + fline - 2);
+
+    MatrixView fileDraws(draws, first, 0, drawsPerFile, npar);
+    Vector logPostDens(drawsPerFile);
+    VectorView logPostDensView(logPostDens, 0, drawsPerFile);
+    VectorView steadyStateView(steadyState, 0, n_endo), deepParamsView(deepParams, 0, n_params);
+    MatrixView QView(Q, 0, 0, n_exo, n_exo);
+    MatrixConstView dataView(fixture.data, 0, 0, 1, n_periods);
+    rwmh.compute(logPostDensView, fileDraws, steadyStateView, start, currentLogPost, deepParamsView, dataView,
+                 QView, H, 0, fline, lline, lpd, proposal, fixture.epd);
+  };
+};
+
+#endif // !defined(MHCF_5C2E81A7_93D4_4B6F_A0E3_7F14D9B26C58__INCLUDED_)
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks the rank-one Cholesky updates, and the adaptation of the proposal on a Gaussian target
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+#include "AdaptiveProposal.hh"
+
+// Largest absolute difference between R'*R and A
+static double
+factorError(const Matrix &R, const Matrix &A)
+{
+  double err = 0;
+  const size_t n = A.getRows();
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      {
+        double s = 0;
+        for (size_t k = 0; k < n; k++)
+          s += R(k, i)*R(k, j);
+        err = std::max(err, fabs(s - A(i, j)));
+      }
+  return err;
+}
+
+int
+main(int argc, char **argv)
+{
+  const size_t n = 3;
+
+  // Rank-one update and downdate of the factor of A = diag(1, 2, 3)
+  Matrix A(n), R(n);
+  A.setAll(0.0);
+  R.setAll(0.0);
+  for (size_t i = 0; i < n; i++)
+    {
+      A(i, i) = i+1;
+      R(i, i) = sqrt(i+1.0);
+    }
+  double xs[] = { 0.5, -1.0, 2.0 };
+  Vector x(n);
+  for (size_t i = 0; i < n; i++)
+    x(i) = xs[i];
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      A(i, j) += xs[i]*xs[j];
+  AdaptiveProposal::choleskyUpdate(R, x);
+  std::cout << "Error of the update: " << factorError(R, A) << std::endl;
+  assert(factorError(R, A) < 1e-12);
+
+  for (size_t i = 0; i < n; i++)
+    {
+      x(i) = xs[i];
+      for (size_t j = 0; j < n; j++)
+        A(i, j) -= xs[i]*xs[j];
+    }
+  assert(AdaptiveProposal::choleskyDowndate(R, x));
+  std::cout << "Error of the downdate: " << factorError(R, A) << std::endl;
+  assert(factorError(R, A) < 1e-12);
+
+  // A downdate which would make the matrix indefinite is detected
+  x.setAll(0.0);
+  x(0) = 2;
+  assert(!AdaptiveProposal::choleskyDowndate(R, x));
+
+  // Metropolis on a correlated Gaussian target, starting from a badly scaled identity proposal
+  Matrix target(n), precision(n), identity(n);
+  target.setAll(0.0);
+  identity.setAll(0.0);
+  target(0, 0) = 4;
+  target(1, 1) = 0.25;
+  target(2, 2) = 1;
+  target(0, 2) = target(2, 0) = 1.2;
+  // Inverse of the target covariance, by blocks
+  precision.setAll(0.0);
+  double det = 4*1 - 1.2*1.2;
+  precision(0, 0) = 1/det;
+  precision(2, 2) = 4/det;
+  precision(0, 2) = precision(2, 0) = -1.2/det;
+  precision(1, 1) = 4;
+  for (size_t i = 0; i < n; i++)
+    identity(i, i) = 1;
+
+  Vector jscale(n);
+  jscale.setAll(0.8);
+  AdaptiveProposal proposal(VectorConstView(jscale.getData(), n, 1),
+                            MatrixConstView(identity.getData(), n, n, n), 0.3);
+  proposal.seed(11);
+
+  Vector state(n), candidate(n);
+  state.setAll(0.0);
+  double logDensity = 0;
+  const size_t nSteps = 200000;
+  size_t accepted = 0;
+  for (size_t k = 0; k < nSteps; k++)
+    {
+      proposal.draw(state, candidate);
+      double q = 0;
+      for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+          q += candidate(i)*precision(i, j)*candidate(j);
+      double newLogDensity = -0.5*q;
+      bool accept = log(proposal.selectionTestDraw()) < newLogDensity - logDensity;
+      if (accept)
+        {
+          state = candidate;
+          logDensity = newLogDensity;
+          if (k >= nSteps/2)
+            accepted++;
+        }
+      proposal.adapt(state, accept);
+    }
+  double rate = (double) accepted/(nSteps/2);
+  std::cout << "Acceptance rate in the second half: " << rate
+            << ", jump scale: " << proposal.getJumpScale() << std::endl;
+  assert(fabs(rate - 0.3) < 0.03);
+  assert(proposal.getAdaptations() == nSteps);
+
+  // The factor has learnt the target covariance (times jscale^2)
+  Matrix scaled(n);
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      scaled(i, j) = 0.64*target(i, j);
+  double err = factorError(proposal.getVar(), scaled);
+  std::cout << "Error of the learnt covariance: " << err << std::endl;
+  assert(err < 0.15*0.64*4);
+
+  // Selecting a chain restarts the adaptation
+  proposal.setChain(1);
+  assert(proposal.getAdaptations() == 0 && proposal.getJumpScale() == 1);
+  assert(factorError(proposal.getVar(), identity) < 1.0);
+}
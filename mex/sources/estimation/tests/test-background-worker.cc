@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+#include <unistd.h>
+
+#include "background_worker.hh"
+
+class AppendJob : public BackgroundWorker::Job
+{
+public:
+  std::vector<int> &output;
+  const int first, n;
+  AppendJob(std::vector<int> &output_arg, int first_arg, int n_arg) :
+    output(output_arg), first(first_arg), n(n_arg)
+  {
+  };
+  virtual void
+  run()
+  {
+    for (int i = first; i < first + n; i++)
+      {
+        usleep(100);
+        output.push_back(i);
+      }
+  };
+};
+
+class FailingJob : public BackgroundWorker::Job
+{
+public:
+  virtual void
+  run()
+  {
+    throw 1;
+  };
+};
+
+int
+main(int argc, char **argv)
+{
+  std::vector<int> output;
+  AppendJob job1(output, 0, 50), job2(output, 50, 50);
+  {
+    BackgroundWorker worker;
+
+    // Jobs run one at a time, in the order of submission
+    for (int k = 0; k < 5; k++)
+      {
+        worker.submit(job1);
+        worker.submit(job2);
+      }
+    worker.wait();
+    assert(output.size() == 500);
+    for (size_t i = 0; i < output.size(); i++)
+      assert(output[i] == (int) i % 100);
+
+    // A failure is reported once, by the next wait() or submit()
+    FailingJob failing;
+    worker.submit(failing);
+    bool thrown = false;
+    try
+      {
+        worker.wait();
+      }
+    catch (const TSException &e)
+      {
+        thrown = true;
+      }
+    assert(thrown);
+    worker.wait();
+
+    // The destructor waits for the last job
+    output.clear();
+    worker.submit(job1);
+  }
+  assert(output.size() == 50);
+
+  std::cout << "Background worker OK" << std::endl;
+}
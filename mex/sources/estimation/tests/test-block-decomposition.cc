@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+#include "Matrix.hh"
+#include "BlockDecomposition.hh"
+
+int
+main(int argc, char **argv)
+{
+  // Equations (rows) in scrambled order:
+  // - a recursive equation in y2
+  // - y0 and y4 are simultaneous, and depend on y2
+  // - y1 depends on y0
+  // - y3 depends on y1 and y2
+  const size_t n = 5;
+  Matrix jacobian(n);
+  jacobian.setAll(0.0);
+  jacobian(0, 1) = 1; jacobian(0, 0) = 2; // y1 = f(y0)
+  jacobian(1, 0) = 1; jacobian(1, 4) = 1; jacobian(1, 2) = 3; // (y0, y4) = g(y2)
+  jacobian(2, 4) = 1; jacobian(2, 0) = -1;
+  jacobian(3, 2) = 5; // y2 = constant
+  jacobian(4, 3) = 1; jacobian(4, 1) = 1; jacobian(4, 2) = -2; // y3 = h(y1, y2)
+  std::cout << "Jacobian:" << std::endl << jacobian << std::endl;
+
+  BlockDecomposition blocks;
+  assert(blocks.compute(jacobian));
+  assert(blocks.getNumBlocks() == 4);
+  assert(blocks.getMaxBlockSize() == 2);
+
+  // Every equation only involves variables of its block or of previous ones
+  std::vector<size_t> blockOfVariable(n, n);
+  size_t nEquations = 0;
+  for (size_t b = 0; b < blocks.getNumBlocks(); b++)
+    {
+      const std::vector<size_t> &eqs = blocks.getEquations(b), &vars = blocks.getVariables(b);
+      assert(eqs.size() == vars.size());
+      for (size_t i = 0; i < vars.size(); i++)
+        blockOfVariable[vars[i]] = b;
+      for (size_t i = 0; i < eqs.size(); i++)
+        {
+          std::cout << "Block " << b << ": equation " << eqs[i] << ", variable " << vars[i] << std::endl;
+          assert(jacobian(eqs[i], vars[i]) != 0);
+          for (size_t j = 0; j < n; j++)
+            if (jacobian(eqs[i], j) != 0)
+              assert(blockOfVariable[j] <= b);
+          nEquations++;
+        }
+    }
+  assert(nEquations == n);
+  assert(blocks.getVariables(0).size() == 1 && blocks.getVariables(0)[0] == 2);
+
+  // A variable which does not appear anywhere makes the system structurally singular
+  for (size_t i = 0; i < n; i++)
+    jacobian(i, 3) = 0;
+  assert(!blocks.compute(jacobian));
+}
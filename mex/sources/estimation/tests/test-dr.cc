@@ -190,4 +190,85 @@ main(int argc, char **argv)
   mat::sub(real_g_u, g_u);
 
   assert(mat::nrminf(real_g_u) < 1e-12);
+
+  // Same results when every other column, and then all columns, are declared parameter-independent
+  for (int all = 0; all < 2; all++)
+    {
+      std::vector<bool> constant_cols(jacobian.getCols());
+      for (size_t j = 0; j < constant_cols.size(); j++)
+        constant_cols[j] = all || j % 2 == 0;
+      dr.setConstantColumns(jacobian, constant_cols);
+
+      // Compute twice, to check that the cached blocks are not altered
+      for (int k = 0; k < 2; k++)
+        {
+          g_y.setAll(0.0);
+          g_u.setAll(0.0);
+          dr.compute(jacobian, g_y, g_u);
+
+          mat::transpose(real_g_y, real_g_y_prime);
+          mat::sub(real_g_y, g_y);
+          assert(mat::nrminf(real_g_y) < 1e-12);
+
+          mat::transpose(real_g_u, real_g_u_prime);
+          mat::sub(real_g_u, g_u);
+          assert(mat::nrminf(real_g_u) < 1e-12);
+        }
+    }
+
+  // A jacobian which contradicts the constant columns drops the cached blocks
+  {
+    Matrix jacobian2(jacobian);
+    for (size_t i = 0; i < jacobian2.getRows(); i++)
+      for (size_t j = 0; j < jacobian2.getCols(); j++)
+        jacobian2(i, j) *= 1 + 1e-3*((i + j) % 3);
+    DecisionRules dr2(endo_nbr, exo_nbr, zeta_fwrd, zeta_back, zeta_mixed,
+                      zeta_static, qz_criterium);
+    Matrix g_y2(g_y), g_u2(g_u);
+    dr2.compute(jacobian2, g_y2, g_u2);
+
+    dr.compute(jacobian2, g_y, g_u);
+    mat::sub(g_y2, g_y);
+    assert(mat::nrminf(g_y2) < 1e-12);
+    mat::sub(g_u2, g_u);
+    assert(mat::nrminf(g_u2) < 1e-12);
+
+    // Same with a sparse jacobian
+    DecisionRules dr_cached(endo_nbr, exo_nbr, zeta_fwrd, zeta_back, zeta_mixed,
+                            zeta_static, qz_criterium);
+    std::vector<bool> constant_cols(jacobian.getCols(), true);
+    dr_cached.setConstantColumns(jacobian, constant_cols);
+    dr2.compute(jacobian2, g_y2, g_u2);
+    dr_cached.compute(CSCMatrix(jacobian2), g_y, g_u);
+    mat::sub(g_y2, g_y);
+    assert(mat::nrminf(g_y2) < 1e-12);
+    mat::sub(g_u2, g_u);
+    assert(mat::nrminf(g_u2) < 1e-12);
+
+    // The cache is gone: the original jacobian gives the original results
+    dr.compute(jacobian, g_y, g_u);
+    mat::transpose(real_g_y, real_g_y_prime);
+    mat::sub(real_g_y, g_y);
+    assert(mat::nrminf(real_g_y) < 1e-12);
+  }
+
+  // Same results with a sparse jacobian, with and without cached blocks
+  CSCMatrix sparse_jacobian(jacobian);
+  DecisionRules dr_sparse(endo_nbr, exo_nbr, zeta_fwrd, zeta_back, zeta_mixed,
+                          zeta_static, qz_criterium);
+  for (int cached = 0; cached < 2; cached++)
+    {
+      DecisionRules &d = cached ? dr : dr_sparse;
+      g_y.setAll(0.0);
+      g_u.setAll(0.0);
+      d.compute(sparse_jacobian, g_y, g_u);
+
+      mat::transpose(real_g_y, real_g_y_prime);
+      mat::sub(real_g_y, g_y);
+      assert(mat::nrminf(real_g_y) < 1e-12);
+
+      mat::transpose(real_g_u, real_g_u_prime);
+      mat::sub(real_g_u, g_u);
+      assert(mat::nrminf(real_g_u) < 1e-12);
+    }
 }
@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+
+#include "dynamic_dll.hh"
+#include "DynamicModelBatch.hh"
+
+// Uses the model of fixture-model.c (fixture_kernel.so): 3 endogenous variables, 1 exogenous, 5 parameters
+static const size_t n_endo = 3, n_exo = 1, n_y = 5, n_jcols = 6;
+
+// Whether the pattern is rejected
+static bool
+rejected(size_t rows, size_t cols, int ncols, const int *colptr, const int *rowind)
+{
+  CSCMatrix g1(rows, cols);
+  try
+    {
+      DynamicModelDLL::setSparsePattern(g1, ncols, colptr, rowind);
+    }
+  catch (const TSException &e)
+    {
+      return true;
+    }
+  return false;
+}
+
+int
+main(int argc, char **argv)
+{
+  // A valid 3x3 pattern with an empty column
+  {
+    const int colptr[] = { 0, 2, 2, 4 }, rowind[] = { 0, 2, 1, 2 };
+    CSCMatrix g1(3, 3);
+    DynamicModelDLL::setSparsePattern(g1, 3, colptr, rowind);
+    assert(g1.getNnz() == 4);
+    assert(g1.colBegin(1) == g1.colEnd(1));
+    assert(g1.rowIndex(2) == 1 && g1.rowIndex(3) == 2);
+  }
+
+  // Wrong number of columns
+  {
+    const int colptr[] = { 0, 1, 2 }, rowind[] = { 0, 1 };
+    assert(rejected(3, 3, 2, colptr, rowind));
+    assert(rejected(3, 3, -1, colptr, rowind));
+  }
+
+  // First column pointer is not 0
+  {
+    const int colptr[] = { 1, 2, 3, 4 }, rowind[] = { 0, 0, 1, 2 };
+    assert(rejected(3, 3, 3, colptr, rowind));
+  }
+
+  // Decreasing column pointers
+  {
+    const int colptr[] = { 0, 2, 1, 3 }, rowind[] = { 0, 1, 2 };
+    assert(rejected(3, 3, 3, colptr, rowind));
+  }
+
+  // A column with more nonzero elements than rows
+  {
+    const int colptr[] = { 0, 4, 4, 4 }, rowind[] = { 0, 1, 2, 3 };
+    assert(rejected(3, 3, 3, colptr, rowind));
+  }
+
+  // Row index out of range, negative or not increasing
+  {
+    const int colptr[] = { 0, 2, 2, 3 };
+    const int rowind1[] = { 0, 3, 1 }, rowind2[] = { -1, 0, 1 }, rowind3[] = { 1, 1, 0 }, rowind4[] = { 2, 0, 0 };
+    assert(rejected(3, 3, 3, colptr, rowind1));
+    assert(rejected(3, 3, 3, colptr, rowind2));
+    assert(rejected(3, 3, 3, colptr, rowind3));
+    assert(rejected(3, 3, 3, colptr, rowind4));
+  }
+
+  // Evaluation at many points, compared with one call to eval() per point
+  const size_t nPoints = 100;
+  Vector params(5), ySteady(n_endo);
+  params(0) = 0.9;
+  params(1) = 0.99;
+  params(2) = 0.5;
+  params(3) = 1.0;
+  params(4) = 1.0;
+  ySteady.setAll(0.0);
+  Matrix Y(n_y, nPoints), X(nPoints, n_exo);
+  for (size_t p = 0; p < nPoints; p++)
+    {
+      for (size_t i = 0; i < n_y; i++)
+        Y(i, p) = 1 + 0.01*p - 0.1*i;
+      X(p, 0) = 0.001*p;
+    }
+
+  DynamicModelDLL dynamicDLL("fixture");
+  Matrix refResiduals(n_endo, nPoints), refG1(n_endo, nPoints*n_jcols);
+  for (size_t p = 0; p < nPoints; p++)
+    {
+      VectorView residual = mat::get_col(refResiduals, p);
+      Matrix x(1, n_exo), g1(n_endo, n_jcols);
+      x(0, 0) = X(p, 0);
+      dynamicDLL.eval(mat::get_col(Y, p), x, params, ySteady, residual, &g1, NULL, NULL);
+      MatrixView(refG1, 0, p*n_jcols, n_endo, n_jcols) = g1;
+    }
+
+  // In two ranges, with and without the jacobian
+  Matrix residuals(n_endo, nPoints), g1(n_endo, nPoints*n_jcols);
+  residuals.setAll(0.0);
+  dynamicDLL.evalPoints(Y, X, params, ySteady, residuals, &g1, 0, 37);
+  dynamicDLL.evalPoints(Y, X, params, ySteady, residuals, NULL, 37, nPoints);
+  for (size_t p = 0; p < nPoints; p++)
+    for (size_t i = 0; i < n_endo; i++)
+      {
+        assert(residuals(i, p) == refResiduals(i, p));
+        if (p < 37)
+          for (size_t j = 0; j < n_jcols; j++)
+            assert(g1(i, p*n_jcols + j) == refG1(i, p*n_jcols + j));
+      }
+
+  // Same results whatever the number of threads
+  for (size_t nWorkers = 1; nWorkers <= 4; nWorkers += 3)
+    {
+      DynamicModelBatch batch("fixture", nWorkers);
+      residuals.setAll(0.0);
+      g1.setAll(0.0);
+      batch.eval(Y, X, params, ySteady, residuals, &g1);
+      for (size_t p = 0; p < nPoints; p++)
+        for (size_t i = 0; i < n_endo; i++)
+          {
+            assert(residuals(i, p) == refResiduals(i, p));
+            for (size_t j = 0; j < n_jcols; j++)
+              assert(g1(i, p*n_jcols + j) == refG1(i, p*n_jcols + j));
+          }
+    }
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include "LogLikelihoodMain.hh"
+
+// Uses the model of fixture-model.c (fixture_kernel.so), with y observed
+
+static const size_t n_endo = 3, n_exo = 1, n_params = 5, n_periods = 60;
+
+struct Outputs
+{
+  double logLikelihood;
+  Vector steadyState, deepParams, vll;
+  Matrix Q, H;
+  Outputs() : steadyState(n_endo), deepParams(n_params), vll(n_periods), Q(n_exo), H(1)
+  {
+  };
+};
+
+static const double params[] = { 0.9, 0.99, 0.5, 1.0, 1.0 }; // rho, beta, alpha, kbar, gamma
+
+// The former sequential evaluation, with a single filter going through all the subsamples
+static double
+evaluateSequentially(EstimatedParametersDescription &epd, const Vector &estParams, const Matrix &data)
+{
+  std::vector<size_t> zeta_fwrd(1, 1), zeta_back(1, 0), zeta_mixed, zeta_static(1, 2), varobs(1, 2);
+  LogLikelihoodSubSample llss("fixture", epd, n_endo, n_exo, zeta_fwrd, zeta_back, zeta_mixed, zeta_static,
+                              1.0+1.0e-9, varobs, 1e-6, 1e-15, false);
+  Vector steadyState(n_endo), deepParams(n_params), vll(n_periods), estParamsCopy(estParams);
+  Matrix Q(n_exo), H(1), detrendedData(1, n_periods);
+  deepParams = VectorConstView(params, n_params, 1);
+  steadyState.setAll(1.0);
+  Q.setAll(0.0);
+  H.setAll(0.0);
+  VectorView steadyStateView(steadyState, 0, n_endo), deepParamsView(deepParams, 0, n_params);
+  MatrixView QView(Q, 0, 0, n_exo, n_exo);
+
+  double logLikelihood = 0;
+  for (size_t i = 0; i < epd.estSubsamples.size(); i++)
+    {
+      size_t startPeriod = epd.estSubsamples[i].startPeriod, length = epd.estSubsamples[i].endPeriod-startPeriod+1;
+      MatrixConstView dataView(data, 0, startPeriod, 1, length);
+      MatrixView detrendedDataView(detrendedData, 0, startPeriod, 1, length);
+      VectorView vllView(vll, startPeriod, length);
+      logLikelihood += llss.compute(steadyStateView, dataView, estParamsCopy, deepParamsView, QView, H,
+                                    vllView, detrendedDataView, 0, i);
+    }
+  return logLikelihood;
+}
+
+static void
+evaluate(EstimatedParametersDescription &epd, const Vector &estParams, const Matrix &data, size_t nThreads, Outputs &out)
+{
+  std::vector<size_t> zeta_fwrd(1, 1), zeta_back(1, 0), zeta_mixed, zeta_static(1, 2), varobs(1, 2);
+  LogLikelihoodMain llm("fixture", epd, n_endo, n_exo, zeta_fwrd, zeta_back, zeta_mixed, zeta_static,
+                        1.0+1.0e-9, varobs, 1e-6, 1e-15, false, nThreads);
+
+  out.deepParams = VectorConstView(params, n_params, 1);
+  out.steadyState.setAll(1.0);
+  out.Q.setAll(0.0);
+  out.H.setAll(0.0);
+  Vector estParamsCopy(estParams);
+  VectorView steadyState(out.steadyState, 0, n_endo), deepParams(out.deepParams, 0, n_params);
+  MatrixView Q(out.Q, 0, 0, n_exo, n_exo);
+  MatrixConstView dataView(data, 0, 0, 1, n_periods);
+  out.logLikelihood = llm.compute(steadyState, estParamsCopy, deepParams, dataView, Q, out.H, 0);
+  out.vll = llm.getVll();
+}
+
+int
+main(int argc, char **argv)
+{
+  // Three subsamples, the deep parameters rho and kbar change across them
+  std::vector<EstimationSubsample> subsamples;
+  subsamples.push_back(EstimationSubsample(0, 19));
+  subsamples.push_back(EstimationSubsample(20, 39));
+  subsamples.push_back(EstimationSubsample(40, n_periods-1));
+  std::vector<size_t> all, first(1, 0), last(1, 2), notFirst;
+  for (size_t i = 0; i < 3; i++)
+    all.push_back(i);
+  notFirst.push_back(1);
+  notFirst.push_back(2);
+
+  GaussianPrior prior(0.0, 1.0, -INFINITY, INFINITY, 0.0, 1.0);
+  std::vector<EstimatedParameter> estParamsInfo;
+  estParamsInfo.push_back(EstimatedParameter(EstimatedParameter::shock_SD, 0, 0, all, 0, 10, &prior));
+  estParamsInfo.push_back(EstimatedParameter(EstimatedParameter::deepPar, 0, 0, first, 0, 1, &prior));
+  estParamsInfo.push_back(EstimatedParameter(EstimatedParameter::deepPar, 0, 0, notFirst, 0, 1, &prior));
+  estParamsInfo.push_back(EstimatedParameter(EstimatedParameter::deepPar, 3, 0, last, 0, 10, &prior));
+  EstimatedParametersDescription epd(subsamples, estParamsInfo);
+
+  Vector estParams(4);
+  estParams(0) = 0.1;
+  estParams(1) = 0.8;
+  estParams(2) = 0.6;
+  estParams(3) = 1.5;
+
+  Matrix data(1, n_periods);
+  for (size_t t = 0; t < n_periods; t++)
+    data(0, t) = 0.1*sin(0.3*t) + (t >= 40 ? 0.5 : 0);
+
+  Outputs serial;
+  evaluate(epd, estParams, data, 1, serial);
+  assert(std::isfinite(serial.logLikelihood));
+
+  // The outputs are those of the last subsample
+  double y = serial.steadyState(2);
+  assert(serial.deepParams(0) == estParams(2) && serial.deepParams(3) == estParams(3));
+  assert(serial.steadyState(0) == estParams(3) && fabs(y*y*y + y - 1.5*estParams(3)) < 1e-7);
+  assert(serial.Q(0, 0) == estParams(0)*estParams(0));
+
+  // Same likelihood as a single filter going through the subsamples, up to the steady state tolerance
+  double sequential = evaluateSequentially(epd, estParams, data);
+  assert(fabs(serial.logLikelihood - sequential) < 1e-6*fabs(sequential));
+
+  // The concurrent evaluation of the subsamples gives exactly the same results
+  for (size_t nThreads = 2; nThreads <= 3; nThreads++)
+    {
+      Outputs threaded;
+      evaluate(epd, estParams, data, nThreads, threaded);
+      assert(threaded.logLikelihood == serial.logLikelihood);
+      for (size_t t = 0; t < n_periods; t++)
+        assert(threaded.vll(t) == serial.vll(t));
+      for (size_t i = 0; i < n_endo; i++)
+        assert(threaded.steadyState(i) == serial.steadyState(i));
+      for (size_t i = 0; i < n_params; i++)
+        assert(threaded.deepParams(i) == serial.deepParams(i));
+      assert(threaded.Q(0, 0) == serial.Q(0, 0) && threaded.H(0, 0) == serial.H(0, 0));
+    }
+}
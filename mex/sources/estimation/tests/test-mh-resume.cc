@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Resumes a chain in a new session, as with load_mh_file, and checks that it
+// continues the uninterrupted chain instead of reusing the numbers of its
+// first draws
+
+#include <cassert>
+
+#include "mh-chain-fixture.hh"
+
+int
+main(int argc, char **argv)
+{
+  ChainFixture fixture;
+
+  // Two files in a single session
+  Matrix reference(2*drawsPerFile, npar);
+  {
+    Session session(fixture);
+    session.run(reference, 1, 1, drawsPerFile);
+    session.run(reference, 2, 1, drawsPerFile);
+  }
+
+  // The second session resumes at the start of the second file, or inside it
+  for (size_t fline = 1; fline <= 3; fline += 2)
+    {
+      Matrix draws(2*drawsPerFile, npar);
+      draws.setAll(0.0);
+      {
+        Session session(fixture);
+        session.run(draws, 1, 1, drawsPerFile);
+        if (fline > 1)
+          session.run(draws, 2, 1, fline-1);
+      }
+      Session resumed(fixture);
+      resumed.proposal.setPosition(RandomWalkMetropolisHastings::resumePosition(2, fline, drawsPerFile));
+      resumed.run(draws, 2, fline, drawsPerFile);
+      assert(resumed.proposal.getPosition() == 2*drawsPerFile);
+
+      for (size_t i = 0; i < 2*drawsPerFile; i++)
+        for (size_t j = 0; j < npar; j++)
+          assert(fabs(draws(i, j) - reference(i, j)) < 1e-12);
+    }
+
+  // Restarting the stream, as before, would have repeated the moves of the first draws
+  Matrix restarted(2*drawsPerFile, npar);
+  {
+    Session session(fixture);
+    session.run(restarted, 1, 1, drawsPerFile);
+  }
+  {
+    Session session(fixture);
+    session.run(restarted, 2, 1, drawsPerFile);
+  }
+  bool differs = false;
+  for (size_t i = drawsPerFile; i < 2*drawsPerFile; i++)
+    for (size_t j = 0; j < npar; j++)
+      differs = differs || restarted(i, j) != reference(i, j);
+  assert(differs);
+}
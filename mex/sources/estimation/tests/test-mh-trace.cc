@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Writes a trace through the buffered sink and reads it back, then checks
+// the draw indices of the trace of a chain resumed in a new session
+
+#include <cassert>
+#include <cstdio>
+#include <iostream>
+
+#include "MHTraceSink.hh"
+#include "mh-chain-fixture.hh"
+
+// Number of records in the trace file of a chain
+static size_t
+countRecords(const std::string &prefix, size_t chain, size_t n)
+{
+  FILE *f = fopen(BufferedMHTraceSink::fileName(prefix, chain).c_str(), "rb");
+  assert(f != NULL);
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fclose(f);
+  return (size_t) size/(sizeof(double)*(4+n));
+}
+
+// Writes nDraws records for a chain, with a new sink
+static void
+writeRecords(const std::string &prefix, size_t chain, size_t n, size_t nDraws, bool append)
+{
+  BufferedMHTraceSink sink(prefix, n, append);
+  Vector proposal(n);
+  proposal.setAll(0.0);
+  for (size_t k = 0; k < nDraws; k++)
+    sink.record(chain, k, 0.5, 0.0, true, proposal);
+}
+
+int
+main(int argc, char **argv)
+{
+  const size_t n = 2, nDraws = 10;
+  const std::string prefix = "test-mh-trace";
+  remove(BufferedMHTraceSink::fileName(prefix, 0).c_str());
+  remove(BufferedMHTraceSink::fileName(prefix, 1).c_str());
+
+  {
+    // A buffer smaller than the number of draws, to exercise the intermediate writes
+    BufferedMHTraceSink sink(prefix, n, false, 3);
+    Vector proposal(n);
+    for (size_t chain = 0; chain < 2; chain++)
+      for (size_t k = 0; k < nDraws; k++)
+        {
+          proposal(0) = chain;
+          proposal(1) = k;
+          sink.record(chain, k, 0.5, -10.0*k, k % 2 == 0, proposal);
+        }
+    // The rest is written when the sink is destroyed
+  }
+
+  for (size_t chain = 0; chain < 2; chain++)
+    {
+      FILE *f = fopen(BufferedMHTraceSink::fileName(prefix, chain).c_str(), "rb");
+      assert(f != NULL);
+      double r[4+n];
+      size_t k = 0;
+      while (fread(r, sizeof(double), 4+n, f) == 4+n)
+        {
+          assert(r[0] == k && r[1] == 0.5 && r[2] == -10.0*k && r[3] == (k % 2 == 0 ? 1 : 0));
+          assert(r[4] == chain && r[5] == k);
+          k++;
+        }
+      fclose(f);
+      std::cout << "Chain " << chain + 1 << ": " << k << " records" << std::endl;
+      assert(k == nDraws);
+    }
+
+  // A new sink truncates the files of a previous run, unless it resumes them
+  writeRecords(prefix, 0, n, 4, false);
+  assert(countRecords(prefix, 0, n) == 4);
+  writeRecords(prefix, 0, n, 3, true);
+  assert(countRecords(prefix, 0, n) == 7);
+
+  remove(BufferedMHTraceSink::fileName(prefix, 0).c_str());
+  remove(BufferedMHTraceSink::fileName(prefix, 1).c_str());
+
+  // The trace of a resumed chain goes on with the indices of the draws of the earlier session
+  ChainFixture fixture;
+  Matrix draws(2*drawsPerFile, npar);
+  {
+    Session session(fixture);
+    BufferedMHTraceSink sink(prefix, npar);
+    session.rwmh.setTraceSink(&sink);
+    session.run(draws, 1, 1, drawsPerFile);
+  }
+  {
+    Session resumed(fixture);
+    BufferedMHTraceSink sink(prefix, npar, true);
+    resumed.rwmh.setTraceSink(&sink);
+    resumed.proposal.setPosition(RandomWalkMetropolisHastings::resumePosition(2, 1, drawsPerFile));
+    resumed.run(draws, 2, 1, drawsPerFile);
+  }
+  FILE *f = fopen(BufferedMHTraceSink::fileName(prefix, 0).c_str(), "rb");
+  assert(f != NULL);
+  double r[4+npar];
+  size_t k = 0;
+  while (fread(r, sizeof(double), 4+npar, f) == 4+npar)
+    {
+      assert(r[0] == k);
+      k++;
+    }
+  fclose(f);
+  assert(k == 2*drawsPerFile);
+  remove(BufferedMHTraceSink::fileName(prefix, 0).c_str());
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include <unistd.h>
+
+#include "model_library.hh"
+
+// A system library, which is always present
+#if defined(__APPLE__)
+# define TEST_LIBRARY "libm.dylib"
+#elif defined(_WIN32) || defined(__CYGWIN32__)
+# define TEST_LIBRARY "kernel32.dll"
+#else
+# define TEST_LIBRARY "libm.so.6"
+#endif
+
+static void
+copyFile(const std::string &from, const std::string &to)
+{
+  std::ifstream src(from.c_str(), std::ios::binary);
+  std::ofstream dst(to.c_str(), std::ios::binary);
+  dst << src.rdbuf();
+}
+
+int
+main(int argc, char **argv)
+{
+  ModelLibraryRegistry &registry = ModelLibraryRegistry::instance();
+  assert(registry.getNumLoaded() == 0);
+
+  // The library is loaded only once
+  LibraryHandle h1 = registry.acquire(TEST_LIBRARY);
+  LibraryHandle h2 = registry.acquire(TEST_LIBRARY);
+  assert(h1 == h2);
+  assert(registry.getNumLoaded() == 1);
+
+  assert(ModelLibraryRegistry::getSymbol(h1, "this_symbol_does_not_exist") == NULL);
+
+  // It stays loaded when no longer referenced, and is handed out again
+  registry.release(h1);
+  registry.release(h2);
+  assert(registry.getNumLoaded() == 1);
+  LibraryHandle h3 = registry.acquire(TEST_LIBRARY);
+  assert(h3 == h1);
+  registry.release(h3);
+
+  // Failure to load a library
+  bool caught = false;
+  try
+    {
+      registry.acquire("./this_model_does_not_exist_dynamic.so");
+    }
+  catch (TSException &e)
+    {
+      std::cout << e.getMessage() << std::endl;
+      caught = true;
+    }
+  assert(caught);
+  assert(registry.getNumLoaded() == 1);
+
+  // Optional model files
+  assert(registry.acquireIfExists("./this_model_does_not_exist_steadystate.so") == NULL);
+
+  // Models without a plain kernel fall back to the MEX files
+  const dynare_model_kernel_info *info;
+  assert(registry.acquireKernel("this_model_does_not_exist", info) == NULL);
+  assert(info == NULL);
+  assert(ModelLibraryRegistry::modelFileName("/tmp/model", "_kernel.so") == "/tmp/model_kernel.so");
+  assert(registry.getNumLoaded() == 1);
+
+#if !defined(_WIN32)
+  // The same file reached by two paths is loaded once
+  char cwd[4096];
+  assert(getcwd(cwd, sizeof(cwd)) != NULL);
+  std::string fName = ModelLibraryRegistry::modelFileName("fixture", "_kernel.so");
+  LibraryHandle h4 = registry.acquire(fName);
+  LibraryHandle h5 = registry.acquire(std::string(cwd) + "/fixture_kernel.so");
+  assert(h4 == h5);
+  assert(registry.getNumLoaded() == 2);
+
+  // The same relative name in another directory is another library
+  char dir[] = "/tmp/test-model-library-XXXXXX";
+  assert(mkdtemp(dir) != NULL);
+  std::string copy = std::string(dir) + "/fixture_kernel.so";
+  copyFile(fName, copy);
+  assert(chdir(dir) == 0);
+  LibraryHandle h6 = registry.acquire(fName);
+  assert(h6 != h4);
+  assert(registry.getNumLoaded() == 3);
+  registry.release(h4);
+  registry.release(h5);
+  registry.release(h6);
+
+  // Back to the first directory
+  assert(chdir(cwd) == 0);
+  LibraryHandle h7 = registry.acquire(fName);
+  assert(h7 == h4);
+  assert(registry.getNumLoaded() == 3);
+  registry.release(h7);
+
+  unlink(copy.c_str());
+  rmdir(dir);
+#endif
+}
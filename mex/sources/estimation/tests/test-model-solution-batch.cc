@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+#include "ModelSolutionBatch.hh"
+
+// Uses the model of fixture-model.c (fixture_kernel.so)
+
+static const size_t n_endo = 3, n_exo = 1, n_params = 5;
+
+int
+main(int argc, char **argv)
+{
+  std::vector<size_t> zeta_fwrd(1, 1), zeta_back(1, 0), zeta_mixed, zeta_static(1, 2);
+  double qz_criterium = 1.0+1.0e-9;
+
+  // rho, beta, alpha, kbar, gamma for each draw
+  const double params[][n_params] = {
+    { 0.9, 0.99, 0.5, 1.0, 1.0 },
+    { 0.5, 0.95, 0.2, 2.0, 3.0 },
+    { 0.9, 1.10, 0.5, 1.0, 1.0 }, // beta > 1: no stable solution
+    { 0.7, 0.90, 1.5, 0.5, 0.5 },
+    { 0.9, 0.99, 0.5, -2.0, -3.0 }, // The Newton solver is stuck at y = 1
+    { 0.2, 0.50, 0.0, 3.0, 2.0 },
+    { 0.8, 0.98, 0.3, 1.5, 1.0 }
+  };
+  const size_t nDraws = sizeof(params) / sizeof(params[0]);
+
+  Matrix deepParams(n_params, nDraws), guesses(n_endo, nDraws);
+  for (size_t d = 0; d < nDraws; d++)
+    for (size_t i = 0; i < n_params; i++)
+      deepParams(i, d) = params[d][i];
+  guesses.setAll(1.0);
+
+  // Serial reference, with a single ModelSolution which, like the batch, solves each vector from its guess
+  ModelSolution modelSolution("fixture", n_endo, n_exo, zeta_fwrd, zeta_back, zeta_mixed, zeta_static, qz_criterium);
+  ModelSolution::Options options;
+  options.disableSteadyStateWarmStarts = true;
+  modelSolution.setOptions(options);
+  Matrix refSteadyStates(guesses), refGhx(n_endo, nDraws), refGhu(n_endo, nDraws);
+  std::vector<int> refStatus(nDraws, ModelSolutionBatch::OK);
+  Matrix ghx(n_endo, 1), ghu(n_endo, n_exo);
+  for (size_t d = 0; d < nDraws; d++)
+    {
+      VectorView steadyState = mat::get_col(refSteadyStates, d);
+      try
+        {
+          modelSolution.compute(steadyState, mat::get_col(deepParams, d), ghx, ghu);
+          mat::get_col(refGhx, d) = mat::get_col(ghx, 0);
+          mat::get_col(refGhu, d) = mat::get_col(ghu, 0);
+        }
+      catch (SteadyStateSolver::SteadyStateException &e)
+        {
+          refStatus[d] = ModelSolutionBatch::STEADY_STATE_FAILURE;
+        }
+      catch (DecisionRules::BlanchardKahnException &e)
+        {
+          refStatus[d] = e.order ? ModelSolutionBatch::BK_ORDER_FAILURE : ModelSolutionBatch::BK_RANK_FAILURE;
+        }
+    }
+  assert(refStatus[2] == ModelSolutionBatch::BK_ORDER_FAILURE);
+  assert(refStatus[4] == ModelSolutionBatch::STEADY_STATE_FAILURE);
+
+  // Check the reference against the closed form of the first order solution
+  for (size_t d = 0; d < nDraws; d++)
+    if (refStatus[d] == ModelSolutionBatch::OK)
+      {
+        double rho = params[d][0], beta = params[d][1], alpha = params[d][2], kbar = params[d][3], gamma = params[d][4];
+        double y = refSteadyStates(2, d), dc = (1-beta)/(1-beta*rho), dy = (1 + alpha*dc)/(3*y*y + gamma);
+        assert(fabs(refSteadyStates(0, d) - kbar) < 1e-9 && fabs(refSteadyStates(1, d) - kbar) < 1e-9);
+        assert(fabs(y*y*y + gamma*y - (1+alpha)*kbar) < 1e-7);
+        assert(fabs(refGhx(0, d) - rho) < 1e-9 && fabs(refGhx(1, d) - dc*rho) < 1e-9 && fabs(refGhx(2, d) - dy*rho) < 1e-9);
+        assert(fabs(refGhu(0, d) - 1) < 1e-9 && fabs(refGhu(1, d) - dc) < 1e-9 && fabs(refGhu(2, d) - dy) < 1e-9);
+      }
+
+  // The batch gives exactly the same results, whatever the number of slots
+  for (size_t nSlots = 1; nSlots <= 4; nSlots++)
+    {
+      ModelSolutionBatch batch("fixture", n_endo, n_exo, zeta_fwrd, zeta_back, zeta_mixed, zeta_static, qz_criterium, nSlots);
+      assert(batch.getNumSlots() == nSlots);
+
+      Matrix steadyStates(guesses), batchGhx(n_endo, nDraws), batchGhu(n_endo, nDraws);
+      std::vector<int> status;
+      batch.compute(deepParams, steadyStates, batchGhx, batchGhu, status);
+
+      assert(status == refStatus);
+      for (size_t d = 0; d < nDraws; d++)
+        if (status[d] == ModelSolutionBatch::OK)
+          for (size_t i = 0; i < n_endo; i++)
+            assert(steadyStates(i, d) == refSteadyStates(i, d)
+                   && batchGhx(i, d) == refGhx(i, d) && batchGhu(i, d) == refGhu(i, d));
+    }
+
+  // The kernel is not evaluated with a parameter vector of another size
+  Vector tooManyParams(n_params+1), steadyState(n_endo);
+  tooManyParams.setAll(0.5);
+  steadyState.setAll(1.0);
+  bool rejected = false;
+  try
+    {
+      modelSolution.compute(steadyState, tooManyParams, ghx, ghu);
+    }
+  catch (TSException &e)
+    {
+      rejected = true;
+    }
+  assert(rejected);
+}
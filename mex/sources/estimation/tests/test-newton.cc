@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+#include "NewtonSolver.hh"
+
+// Rosenbrock function, in its nonlinear system form; the solution is (1, 1)
+class Rosenbrock : public NewtonSolver::System
+{
+public:
+  virtual void
+  residuals(const Vector &x, Vector &F)
+  {
+    F(0) = 10*(x(1) - x(0)*x(0));
+    F(1) = 1 - x(0);
+  };
+  virtual void
+  jacobian(const Vector &x, Vector &F, Matrix &J)
+  {
+    residuals(x, F);
+    J(0, 0) = -20*x(0);
+    J(0, 1) = 10;
+    J(1, 0) = -1;
+    J(1, 1) = 0;
+  };
+};
+
+// Mildly nonlinear tridiagonal system, solved by x(i) = 1
+class Tridiagonal : public NewtonSolver::System
+{
+public:
+  const size_t n;
+  Tridiagonal(size_t n_arg) : n(n_arg)
+  {
+  };
+  virtual void
+  residuals(const Vector &x, Vector &F)
+  {
+    for (size_t i = 0; i < n; i++)
+      {
+        F(i) = 3*x(i) + 0.5*x(i)*x(i) - 3.5;
+        if (i > 0)
+          F(i) += 0.1*(x(i-1)*x(i-1) - 1);
+        if (i < n-1)
+          F(i) -= 0.2*(x(i+1) - 1);
+      }
+  };
+  virtual void
+  jacobian(const Vector &x, Vector &F, Matrix &J)
+  {
+    residuals(x, F);
+    J.setAll(0.0);
+    for (size_t i = 0; i < n; i++)
+      {
+        J(i, i) = 3 + x(i);
+        if (i > 0)
+          J(i, i-1) = 0.2*x(i-1);
+        if (i < n-1)
+          J(i, i+1) = -0.2;
+      }
+  };
+};
+
+// x^2 + 1 = 0 has no real solution
+class NoSolution : public NewtonSolver::System
+{
+public:
+  virtual void
+  residuals(const Vector &x, Vector &F)
+  {
+    F(0) = x(0)*x(0) + 1;
+  };
+  virtual void
+  jacobian(const Vector &x, Vector &F, Matrix &J)
+  {
+    residuals(x, F);
+    J(0, 0) = 2*x(0);
+  };
+};
+
+int
+main(int argc, char **argv)
+{
+  const double tolerance = 1e-10;
+
+  Rosenbrock rosenbrock;
+  NewtonSolver solver2(2, tolerance, 1000);
+  Vector x2(2);
+  x2(0) = -1.2;
+  x2(1) = 1;
+  assert(solver2.solve(rosenbrock, x2));
+  std::cout << "Rosenbrock: " << solver2.getIterations() << " iterations, "
+            << solver2.getJacobianEvaluations() << " jacobian evaluations" << std::endl;
+  assert(fabs(x2(0) - 1) < 1e-8 && fabs(x2(1) - 1) < 1e-8);
+
+  // The solver can be used again, without reallocation
+  x2(0) = 5;
+  x2(1) = -3;
+  assert(solver2.solve(rosenbrock, x2));
+  assert(fabs(x2(0) - 1) < 1e-8 && fabs(x2(1) - 1) < 1e-8);
+
+  // Close to the solution, quasi-Newton steps save jacobian evaluations
+  const size_t n = 20;
+  Tridiagonal tridiagonal(n);
+  NewtonSolver solver(n, tolerance, 1000);
+  Vector x(n);
+  for (size_t i = 0; i < n; i++)
+    x(i) = 1.5 - 0.05*i;
+  assert(solver.solve(tridiagonal, x));
+  std::cout << "Tridiagonal: " << solver.getIterations() << " iterations, "
+            << solver.getJacobianEvaluations() << " jacobian evaluations" << std::endl;
+  assert(solver.getJacobianEvaluations() < solver.getIterations());
+  for (size_t i = 0; i < n; i++)
+    assert(fabs(x(i) - 1) < 1e-8);
+
+  // In case of failure, the initial value is preserved
+  NoSolution noSolution;
+  NewtonSolver solver1(1, tolerance, 100);
+  Vector x1(1);
+  x1(0) = 2;
+  assert(!solver1.solve(noSolution, x1));
+  assert(x1(0) == 2);
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks the round trip and the Jacobian of the unconstrained parameterization
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+#include "ParameterTransform.hh"
+
+class Params
+{
+public:
+  std::vector<double> values;
+  Params(size_t n) : values(n)
+  {
+  };
+  size_t
+  getSize() const
+  {
+    return values.size();
+  };
+  double &
+  operator()(size_t i)
+  {
+    return values[i];
+  };
+  double
+  operator()(size_t i) const
+  {
+    return values[i];
+  };
+};
+
+int
+main(int argc, char **argv)
+{
+  std::vector<Prior *> priors;
+  priors.push_back(new BetaPrior(0.5, 0.2, 0.0, 1.0, 2.5, 3.5));
+  priors.push_back(new GammaPrior(2, 1, 0.0, INFINITY, 4, 0.5));
+  priors.push_back(new GaussianPrior(1, 0.5, -INFINITY, INFINITY, 1, 0.5));
+  priors.push_back(new InvGamma1_Prior(0.1, 2, 0.0, INFINITY, 0.02, 4));
+  priors.push_back(new GaussianPrior(1, 0.5, -INFINITY, INFINITY, 1, 0.5));
+  priors.push_back(new UniformPrior(0.5, 0.3, -5.0, 5.0, -1.0, 2.0));
+
+  // The estimation bounds of the last Gaussian make it bounded above only
+  double lower[] = { -INFINITY, -INFINITY, -INFINITY, -INFINITY, -INFINITY, -10 };
+  double upper[] = { INFINITY, INFINITY, INFINITY, INFINITY, 3, 10 };
+
+  std::vector<EstimatedParameter> estParams;
+  std::vector<size_t> subSampleIDs(1, 0);
+  for (size_t i = 0; i < priors.size(); i++)
+    estParams.push_back(EstimatedParameter(EstimatedParameter::deepPar, i, 0, subSampleIDs,
+                                           lower[i], upper[i], priors[i]));
+
+  ParameterTransform transform(estParams);
+  const size_t n = transform.getSize();
+  assert(n == priors.size());
+  assert(transform.getKind(0) == ParameterTransform::Bounded);
+  assert(transform.getKind(1) == ParameterTransform::LowerBounded);
+  assert(transform.getKind(2) == ParameterTransform::Identity);
+  assert(transform.getKind(3) == ParameterTransform::LowerBounded);
+  assert(transform.getKind(4) == ParameterTransform::UpperBounded);
+  assert(transform.getKind(5) == ParameterTransform::Bounded);
+  assert(transform.getLowerBound(5) == -1.0 && transform.getUpperBound(5) == 2.0);
+
+  double xs[] = { 0.999, 0.01, -3.0, 0.2, 2.9, 1.5 };
+  Params x(n), u(n), y(n);
+  x.values.assign(xs, xs + n);
+  transform.toUnconstrained(x, u);
+  transform.toConstrained(u, y);
+  for (size_t i = 0; i < n; i++)
+    {
+      std::cout << "x = " << x(i) << ", u = " << u(i) << std::endl;
+      assert(fabs(y(i) - x(i)) < 1e-12*(1 + fabs(x(i))));
+    }
+
+  // The Jacobian is diagonal; compare each derivative with finite differences
+  const double h = 1e-6;
+  double logJ = 0;
+  for (size_t i = 0; i < n; i++)
+    {
+      double d = (transform.toConstrained(i, u(i)+h) - transform.toConstrained(i, u(i)-h))/(2*h);
+      assert(fabs(log(fabs(d)) - transform.logDerivative(i, u(i))) < 1e-6);
+      logJ += log(fabs(d));
+    }
+  assert(fabs(logJ - transform.logJacobian(u)) < 1e-5);
+
+  // Far in the tails, the constrained values stay within the bounds and the Jacobian is finite
+  assert(transform.toConstrained(0, 800) <= 1.0 && transform.toConstrained(0, -800) >= 0.0);
+  assert(std::isfinite(transform.logDerivative(0, 800)) && std::isfinite(transform.logDerivative(0, -800)));
+
+  for (size_t i = 0; i < priors.size(); i++)
+    delete priors[i];
+}
@@ -0,0 +1,84 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Known-answer and reproducibility tests of the counter-based generator
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+#include "philox.hh"
+
+int
+main(int argc, char **argv)
+{
+  // Known-answer vectors of the Random123 distribution
+  const uint32_t ctr[3][4] = { { 0, 0, 0, 0 },
+                               { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff },
+                               { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 } };
+  const uint32_t key[3][2] = { { 0, 0 }, { 0xffffffff, 0xffffffff }, { 0xa4093822, 0x299f31d0 } };
+  const uint32_t expected[3][4] = { { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 },
+                                    { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd },
+                                    { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 } };
+  for (int t = 0; t < 3; t++)
+    {
+      uint32_t out[4];
+      PhiloxStream::bijection(ctr[t], key[t], out);
+      std::cout << std::hex << out[0] << " " << out[1] << " " << out[2] << " " << out[3] << std::dec << std::endl;
+      for (int i = 0; i < 4; i++)
+        assert(out[i] == expected[t][i]);
+    }
+
+  // Blocks only depend on (seed, stream, chain, index, block)
+  PhiloxStream a(42, 0), b(42, 0), c(42, 1), d(43, 0);
+  double x1, x2, y1, y2;
+  a.uniforms(3, 1000000007ULL, 2, x1, x2);
+  b.uniforms(3, 1000000007ULL, 2, y1, y2);
+  assert(x1 == y1 && x2 == y2);
+  c.uniforms(3, 1000000007ULL, 2, y1, y2);
+  assert(x1 != y1);
+  d.uniforms(3, 1000000007ULL, 2, y1, y2);
+  assert(x1 != y1);
+  a.uniforms(4, 1000000007ULL, 2, y1, y2);
+  assert(x1 != y1);
+
+  // The batched normal numbers are those of the successive blocks
+  double z[5];
+  a.fillNormals(1, 17, z, 5);
+  for (uint32_t blk = 0; blk < 3; blk++)
+    {
+      a.normals(1, 17, blk, x1, x2);
+      assert(z[2*blk] == x1);
+      if (2*blk+1 < 5)
+        assert(z[2*blk+1] == x2);
+    }
+
+  // Moments of the normal numbers
+  const size_t n = 200000;
+  double sum = 0, sum2 = 0;
+  for (size_t i = 0; i < n/2; i++)
+    {
+      a.normals(0, i, 0, x1, x2);
+      sum += x1 + x2;
+      sum2 += x1*x1 + x2*x2;
+    }
+  double mean = sum/n, var = sum2/n - mean*mean;
+  std::cout << "Normal numbers: mean " << mean << ", variance " << var << std::endl;
+  assert(fabs(mean) < 0.01 && fabs(var - 1) < 0.02);
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Compares the closed-form log densities of PriorBlock with log(pdf) of the Prior classes
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+#include "PriorBlock.hh"
+
+class Params
+{
+public:
+  std::vector<double> values;
+  size_t
+  getSize() const
+  {
+    return values.size();
+  };
+  double
+  operator()(size_t i) const
+  {
+    return values[i];
+  };
+};
+
+int
+main(int argc, char **argv)
+{
+  std::vector<Prior *> priors;
+  priors.push_back(new BetaPrior(0.5, 0.2, 0.0, 1.0, 2.5, 3.5));
+  priors.push_back(new GaussianPrior(1, 0.5, -100, 100, 1, 0.5));
+  priors.push_back(new GammaPrior(2, 1, 0.0, 100, 4, 0.5));
+  priors.push_back(new BetaPrior(0.5, 0.2, -1.0, 2.0, 1.5, 2.0));
+  priors.push_back(new InvGamma1_Prior(0.1, 2, 0.0, 100, 0.02, 4));
+  priors.push_back(new UniformPrior(0.5, 0.3, 0.0, 1.0, 0.0, 1.0));
+  priors.push_back(new InvGamma2_Prior(0.1, 2, 0.0, 100, 0.3, 5));
+  priors.push_back(new GaussianPrior(0, 1, -5, 5, 0, 1));
+
+  std::vector<EstimatedParameter> estParams;
+  std::vector<size_t> subSampleIDs(1, 0);
+  for (size_t i = 0; i < priors.size(); i++)
+    estParams.push_back(EstimatedParameter(EstimatedParameter::deepPar, i, 0, subSampleIDs,
+                                           priors[i]->lower_bound, priors[i]->upper_bound, priors[i]));
+
+  PriorBlock block(estParams);
+  assert(block.getSize() == priors.size());
+
+  Params ep;
+  double x[] = { 0.3, 1.2, 1.7, 0.4, 0.15, 0.25, 0.2, -0.3 };
+  ep.values.assign(x, x + priors.size());
+
+  double expected = 0;
+  for (size_t i = 0; i < priors.size(); i++)
+    expected += log(priors[i]->pdf(ep(i)));
+  double computed = block.compute(ep);
+  std::cout << "Log prior density: " << computed << " (expected " << expected << ")" << std::endl;
+  assert(fabs(computed - expected) < 1e-10*fabs(expected));
+
+  // Far in the tail of the Gaussian, log(pdf) underflows but the closed form does not
+  ep.values[1] = 30;
+  assert(priors[1]->pdf(ep(1)) == 0);
+  computed = block.compute(ep);
+  std::cout << "Log prior density in the tails: " << computed << std::endl;
+  assert(std::isfinite(computed));
+
+  // Outside of the support
+  ep.values[1] = 1;
+  ep.values[4] = -0.1;
+  computed = block.compute(ep);
+  assert(std::isinf(computed) && computed < 0);
+
+  ep.values[4] = 0.15;
+  ep.values[3] = 2.5;
+  computed = block.compute(ep);
+  assert(std::isinf(computed) && computed < 0);
+
+  for (size_t i = 0; i < priors.size(); i++)
+    delete priors[i];
+}
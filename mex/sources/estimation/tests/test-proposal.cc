@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Checks that the batched proposal draws are reproducible and have the requested covariance
+
+#include <cassert>
+#include <cmath>
+#include <iostream>
+
+#include "Proposal.hh"
+
+int
+main(int argc, char **argv)
+{
+  const size_t n = 3;
+  Matrix cov(n);
+  cov(0, 0) = 4;
+  cov(0, 1) = cov(1, 0) = 1;
+  cov(0, 2) = cov(2, 0) = -0.5;
+  cov(1, 1) = 2;
+  cov(1, 2) = cov(2, 1) = 0.3;
+  cov(2, 2) = 1;
+  Vector jscale(n);
+  jscale.setAll(0.5);
+
+  Proposal proposal(VectorConstView(jscale.getData(), n, 1), MatrixConstView(cov.getData(), n, n, n));
+  proposal.seed(7);
+
+  Vector mean(n), draw(n), other(n);
+  mean(0) = 1;
+  mean(1) = -2;
+  mean(2) = 3;
+
+  // Sample covariance of many draws, which cross several batches
+  const size_t nDraws = 100000;
+  Matrix sum2(n);
+  sum2.setAll(0.0);
+  Vector draw100(n);
+  double u100 = 0;
+  for (size_t k = 0; k < nDraws; k++)
+    {
+      proposal.draw(mean, draw);
+      double u = proposal.selectionTestDraw();
+      assert(u > 0 && u < 1);
+      if (k == 100)
+        {
+          draw100 = draw;
+          u100 = u;
+        }
+      for (size_t i = 0; i < n; i++)
+        for (size_t j = 0; j < n; j++)
+          sum2(i, j) += (draw(i) - mean(i))*(draw(j) - mean(j));
+    }
+  for (size_t i = 0; i < n; i++)
+    for (size_t j = 0; j < n; j++)
+      {
+        double expected = 0.25*cov(i, j), sample = sum2(i, j)/nDraws;
+        std::cout << sample << (j == n-1 ? "\n" : " ");
+        assert(fabs(sample - expected) < 0.03);
+      }
+
+  // Any draw can be reproduced from its index
+  proposal.setPosition(100);
+  proposal.draw(mean, other);
+  for (size_t i = 0; i < n; i++)
+    assert(other(i) == draw100(i));
+  assert(proposal.selectionTestDraw() == u100);
+  assert(proposal.getPosition() == 101);
+
+  // Another chain gives other numbers
+  proposal.setChain(1);
+  proposal.setPosition(100);
+  proposal.draw(mean, other);
+  assert(other(0) != draw100(0));
+
+  // A clone continues the same stream independently of the original
+  Proposal *clone = proposal.clone();
+  proposal.setChain(0);
+  proposal.setPosition(100);
+  proposal.draw(mean, other);
+  assert(other(0) == draw100(0));
+  assert(clone->getChain() == 1 && clone->getPosition() == 101);
+  clone->setChain(0);
+  clone->setPosition(100);
+  clone->draw(mean, other);
+  for (size_t i = 0; i < n; i++)
+    assert(other(i) == draw100(i));
+  delete clone;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <iostream>
+
+#include "SteadyStateCache.hh"
+
+int
+main(int argc, char **argv)
+{
+  const size_t n_params = 3, n_endo = 2, capacity = 4;
+  SteadyStateCache cache(n_params, n_endo, capacity);
+  Vector params(n_params), steadyState(n_endo);
+
+  assert(!cache.findNearest(params, steadyState));
+
+  // Entry k has parameters (k, 0.01*k, 100) and steady state (k, -k)
+  for (size_t k = 0; k < 6; k++)
+    {
+      params(0) = k;
+      params(1) = 0.01*k;
+      params(2) = 100;
+      steadyState(0) = k;
+      steadyState(1) = -(double) k;
+      cache.insert(params, steadyState);
+    }
+  // Only the last four entries are kept
+  assert(cache.getSize() == capacity);
+
+  // The distance is relative to the magnitude of the parameters: in absolute terms, entry 5 would be the nearest
+  params(0) = 5;
+  params(1) = 0.031;
+  params(2) = 100;
+  assert(cache.findNearest(params, steadyState));
+  std::cout << "Nearest steady state: " << steadyState(0) << " " << steadyState(1) << std::endl;
+  assert(steadyState(0) == 4 && steadyState(1) == -4);
+
+  // Entries 0 and 1 have been evicted
+  params(0) = 0;
+  params(1) = 0;
+  assert(cache.findNearest(params, steadyState));
+  assert(steadyState(0) == 2);
+
+  cache.clear();
+  assert(cache.getSize() == 0 && !cache.findNearest(params, steadyState));
+}
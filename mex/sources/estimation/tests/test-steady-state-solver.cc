@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <cmath>
+
+#include "SteadyStateSolver.hh"
+
+// Uses the model of fixture-model.c: "fixture" only has a kernel, "fixture_ss" also has a steady state DLL
+
+static const size_t n_endo = 3, n_exo = 1, n_params = 5;
+
+// Whether the computation of the steady state throws
+static bool
+fails(SteadyStateSolver &solver, Vector &steadyState, const Matrix &Mx, const Vector &params)
+{
+  try
+    {
+      solver.compute(steadyState, Mx, params);
+    }
+  catch (SteadyStateSolver::SteadyStateException &e)
+    {
+      return true;
+    }
+  return false;
+}
+
+int
+main(int argc, char **argv)
+{
+  // rho, beta, alpha, kbar, gamma
+  Vector params(n_params);
+  params(0) = 0.9;
+  params(1) = 0.99;
+  params(2) = 0.5;
+  params(3) = 2.0;
+  params(4) = 1.0;
+  Matrix Mx(1, n_exo);
+  Mx.setAll(0.0);
+  Vector steadyState(n_endo), closedForm(n_endo);
+
+  // Closed form of the steady state
+  {
+    SteadyStateSolver solver("fixture", n_endo);
+    assert(!solver.hasAnalyticSteadyState());
+    SteadyStateSolver ssSolver("fixture_ss", n_endo);
+    assert(ssSolver.hasAnalyticSteadyState());
+
+    steadyState.setAll(1.0);
+    solver.compute(steadyState, Mx, params);
+    closedForm.setAll(0.0);
+    ssSolver.compute(closedForm, Mx, params);
+    for (size_t i = 0; i < n_endo; i++)
+      assert(fabs(closedForm(i) - steadyState(i)) < 1e-8);
+
+    // Checked against the static model
+    ssSolver.setCheckAnalyticSteadyState(true);
+    closedForm.setAll(0.0);
+    ssSolver.compute(closedForm, Mx, params);
+    for (size_t i = 0; i < n_endo; i++)
+      assert(fabs(closedForm(i) - steadyState(i)) < 1e-8);
+
+    // The steady state DLL returns an error code when gamma <= 0, with or without the check
+    params(4) = -1.0;
+    assert(fails(ssSolver, closedForm, Mx, params));
+    ssSolver.setCheckAnalyticSteadyState(false);
+    assert(fails(ssSolver, closedForm, Mx, params));
+    params(4) = 1.0;
+
+    // The steady state DLL ignores the exogenous variables: only the check detects that its result is wrong
+    Mx(0, 0) = 0.1;
+    closedForm.setAll(0.0);
+    assert(!fails(ssSolver, closedForm, Mx, params));
+    assert(closedForm(0) == params(3));
+    ssSolver.setCheckAnalyticSteadyState(true);
+    assert(fails(ssSolver, closedForm, Mx, params));
+    Mx(0, 0) = 0.0;
+  }
+
+  // Solution by blocks: the secant iterations of the equation in y overshoot, and the trust-region solver takes over
+  {
+    Vector params2(params);
+    params2(2) = 0.25;
+    params2(4) = -3.0;
+    SteadyStateSolver solver("fixture", n_endo);
+    steadyState(0) = 2.0;
+    steadyState(1) = 2.0;
+    steadyState(2) = 1.2;
+    solver.compute(steadyState, Mx, params2);
+    double y = steadyState(2);
+    assert(steadyState(0) == 2.0 && steadyState(1) == 2.0);
+    assert(fabs(y*y*y - 3*y - 2.5) < 1e-7 && y > 1.5);
+  }
+
+  // Recovery: from y = 1, the solver is stuck at a local minimum of the squared residual of y^3 - 3*y + 3
+  {
+    Vector params2(params);
+    params2(3) = -2.0;
+    params2(4) = -3.0;
+    const size_t nStarts = 64;
+    Vector guess(n_endo), reference(n_endo);
+    guess.setAll(1.0);
+
+    SteadyStateSolver solver("fixture", n_endo);
+    steadyState = guess;
+    assert(fails(solver, steadyState, Mx, params2));
+
+    // The successful restart with the lowest index is kept, whatever the number of threads
+    long firstSuccess = -1;
+    for (size_t nThreads = 1; nThreads <= 4; nThreads++)
+      {
+        SteadyStateSolver recoverySolver("fixture", n_endo);
+        recoverySolver.setRecovery(nStarts, nThreads);
+        steadyState = guess;
+        recoverySolver.compute(steadyState, Mx, params2);
+        double y = steadyState(2);
+        assert(fabs(y*y*y - 3*y + 3) < 1e-7);
+        if (nThreads == 1)
+          {
+            firstSuccess = recoverySolver.getLastRecoveryStart();
+            assert(firstSuccess > 0 && firstSuccess < (long) nStarts);
+            reference = steadyState;
+          }
+        else
+          {
+            assert(recoverySolver.getLastRecoveryStart() == firstSuccess);
+            for (size_t i = 0; i < n_endo; i++)
+              assert(steadyState(i) == reference(i));
+          }
+      }
+
+    // The restarts with lower indices all fail
+    SteadyStateSolver fewerStarts("fixture", n_endo);
+    fewerStarts.setRecovery((size_t) firstSuccess, 3);
+    steadyState = guess;
+    assert(fails(fewerStarts, steadyState, Mx, params2));
+
+    // Without failure, no restart is used
+    solver.setRecovery(nStarts, 2);
+    steadyState.setAll(0.0);
+    solver.compute(steadyState, Mx, params);
+    assert(solver.getLastRecoveryStart() == -1);
+  }
+}
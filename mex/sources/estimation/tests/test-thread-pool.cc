@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+#include "thread_pool.hh"
+
+class SquareTask : public ThreadPool::Task
+{
+public:
+  std::vector<double> &results;
+  std::vector<size_t> &workers;
+  const size_t nWorkers;
+  SquareTask(std::vector<double> &results_arg, std::vector<size_t> &workers_arg, size_t nWorkers_arg) :
+    results(results_arg), workers(workers_arg), nWorkers(nWorkers_arg)
+  {
+  };
+  virtual void
+  run(size_t item, size_t worker)
+  {
+    assert(worker < nWorkers);
+    results[item] = (double) item * item;
+    workers[item] = worker;
+  };
+};
+
+class FailingTask : public ThreadPool::Task
+{
+public:
+  std::vector<int> &done;
+  FailingTask(std::vector<int> &done_arg) : done(done_arg)
+  {
+  };
+  virtual void
+  run(size_t item, size_t worker)
+  {
+    done[item] = 1;
+    if (item == 3)
+      throw 1;
+  };
+};
+
+int
+main(int argc, char **argv)
+{
+  size_t n = 1000;
+
+  for (size_t nWorkers = 1; nWorkers <= 4; nWorkers += 3)
+    {
+      ThreadPool pool(nWorkers);
+      assert(pool.getNumWorkers() == nWorkers);
+
+      // Several generations of work with the same threads
+      for (int k = 0; k < 10; k++)
+        {
+          std::vector<double> results(n, -1);
+          std::vector<size_t> workers(n);
+          SquareTask task(results, workers, nWorkers);
+          pool.run(task, n);
+          for (size_t i = 0; i < n; i++)
+            assert(results[i] == (double) i * i);
+          if (nWorkers == 1)
+            for (size_t i = 0; i < n; i++)
+              assert(workers[i] == 0);
+        }
+
+      // An empty range of items
+      std::vector<double> results;
+      std::vector<size_t> workers;
+      SquareTask empty(results, workers, nWorkers);
+      pool.run(empty, 0);
+
+      // An exception in a task is reported after all items are processed
+      std::vector<int> done(10, 0);
+      FailingTask failing(done);
+      bool caught = false;
+      try
+        {
+          pool.run(failing, done.size());
+        }
+      catch (TSException &e)
+        {
+          caught = true;
+        }
+      assert(caught);
+      for (size_t i = 0; i < done.size(); i++)
+        assert(done[i] == 1);
+    }
+
+  std::cout << "Default number of workers: " << ThreadPool::defaultNumWorkers() << std::endl;
+}
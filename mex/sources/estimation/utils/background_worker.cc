@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "background_worker.hh"
+
+BackgroundWorker::BackgroundWorker() throw (TSException) :
+  job(NULL), failed(false), shutdown(false)
+{
+  pthread_mutex_init(&mutex, NULL);
+  pthread_cond_init(&jobAvailable, NULL);
+  pthread_cond_init(&jobDone, NULL);
+
+  if (pthread_create(&thread, NULL, threadMain, this) != 0)
+    {
+      pthread_cond_destroy(&jobDone);
+      pthread_cond_destroy(&jobAvailable);
+      pthread_mutex_destroy(&mutex);
+      throw TSException(__FILE__, __LINE__, "Can't create thread");
+    }
+}
+
+BackgroundWorker::~BackgroundWorker()
+{
+  pthread_mutex_lock(&mutex);
+  while (job != NULL)
+    pthread_cond_wait(&jobDone, &mutex);
+  shutdown = true;
+  pthread_cond_signal(&jobAvailable);
+  pthread_mutex_unlock(&mutex);
+
+  pthread_join(thread, NULL);
+
+  pthread_cond_destroy(&jobDone);
+  pthread_cond_destroy(&jobAvailable);
+  pthread_mutex_destroy(&mutex);
+}
+
+void
+BackgroundWorker::submit(Job &job_arg) throw (TSException)
+{
+  wait();
+
+  pthread_mutex_lock(&mutex);
+  job = &job_arg;
+  pthread_cond_signal(&jobAvailable);
+  pthread_mutex_unlock(&mutex);
+}
+
+void
+BackgroundWorker::wait() throw (TSException)
+{
+  pthread_mutex_lock(&mutex);
+  while (job != NULL)
+    pthread_cond_wait(&jobDone, &mutex);
+  bool failed_copy = failed;
+  failed = false;
+  pthread_mutex_unlock(&mutex);
+
+  TS_RAISE_IF(failed_copy, "Uncaught exception in a job of the background worker");
+}
+
+void *
+BackgroundWorker::threadMain(void *arg)
+{
+  BackgroundWorker *worker = (BackgroundWorker *) arg;
+
+  while (true)
+    {
+      pthread_mutex_lock(&worker->mutex);
+      while (!worker->shutdown && worker->job == NULL)
+        pthread_cond_wait(&worker->jobAvailable, &worker->mutex);
+      if (worker->shutdown)
+        {
+          pthread_mutex_unlock(&worker->mutex);
+          return NULL;
+        }
+      Job *j = worker->job;
+      pthread_mutex_unlock(&worker->mutex);
+
+      bool failed = false;
+      try
+        {
+          j->run();
+        }
+      catch (...)
+        {
+          failed = true;
+        }
+
+      pthread_mutex_lock(&worker->mutex);
+      worker->failed = failed;
+      worker->job = NULL;
+      pthread_cond_signal(&worker->jobDone);
+      pthread_mutex_unlock(&worker->mutex);
+    }
+}
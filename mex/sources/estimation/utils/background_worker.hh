@@ -0,0 +1,76 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BACKGROUND_WORKER_HH
+#define BACKGROUND_WORKER_HH
+
+#include <pthread.h>
+
+#include "ts_exception.h"
+
+/**
+ * A single POSIX thread which executes jobs in the background, one at a time
+ * and in the order of submission, while the submitting thread goes on with
+ * its own work. It is typically used to write results to disk while the next
+ * ones are being computed.
+ *
+ * A job and the data it uses must not be modified until wait() has returned.
+ * Like the tasks of a ThreadPool, a job must not access the MATLAB/Octave API.
+ **/
+class BackgroundWorker
+{
+public:
+  class Job
+  {
+  public:
+    virtual ~Job()
+    {
+    };
+    virtual void run() = 0;
+  };
+
+  BackgroundWorker() throw (TSException);
+  //! Waits for the current job, if any, before stopping the thread
+  virtual ~BackgroundWorker();
+
+  //! Starts the job in the background, after waiting for the previous one
+  /*! Throws if the previous job threw an exception */
+  void submit(Job &job_arg) throw (TSException);
+  //! Waits for the completion of the current job, if any
+  /*! Throws if it threw an exception */
+  void wait() throw (TSException);
+
+private:
+  pthread_t thread;
+  pthread_mutex_t mutex;
+  pthread_cond_t jobAvailable, jobDone;
+
+  // The fields below are protected by mutex
+  //! The job submitted and not yet completed, if any
+  Job *job;
+  bool failed, shutdown;
+
+  static void *threadMain(void *arg);
+
+  // Not copyable
+  BackgroundWorker(const BackgroundWorker &);
+  BackgroundWorker &operator=(const BackgroundWorker &);
+};
+
+#endif
@@ -19,72 +19,91 @@
 
 #include "dynamic_dll.hh"
 
-#include <sstream>
-
-using namespace std;
-
 DynamicModelDLL::DynamicModelDLL(const std::string &basename) throw (TSException)
 {
-  std::string fName;
-#if !defined(__CYGWIN32__) && !defined(_WIN32)
-  if (basename[0] != '/')
-    fName = "./";
-#endif
-  fName += basename + "_dynamic" + MEXEXT;
+  ModelLibraryRegistry &registry = ModelLibraryRegistry::instance();
 
-  try
+  // A plain kernel takes precedence over the MEX file
+  dynamicHinstance = registry.acquireKernel(basename, kernelInfo);
+  if (dynamicHinstance != NULL)
     {
-#if defined(__CYGWIN32__) || defined(_WIN32)
-      dynamicHinstance = LoadLibrary(fName.c_str());
-      if (dynamicHinstance == NULL)
-        throw 1;
-      Dynamic = (DynamicFn) GetProcAddress(dynamicHinstance, "Dynamic");
-      if (Dynamic == NULL)
+      if (kernelInfo->derivative_order < 1 || kernelInfo->dynamic_symbol == NULL)
         {
-          FreeLibrary(dynamicHinstance); // Free the library
-          throw 2;
+          registry.release(dynamicHinstance);
+          throw TSException(__FILE__, __LINE__, "The kernel of " + basename + " can't compute the jacobian of the dynamic model");
         }
-#else // Linux or Mac
-      dynamicHinstance = dlopen(fName.c_str(), RTLD_NOW);
-      if ((dynamicHinstance == NULL) || dlerror())
-        {
-          cerr << dlerror() << endl;
-          throw 1;
-        }
-      Dynamic = (DynamicFn) dlsym(dynamicHinstance, "Dynamic");
-      if ((Dynamic  == NULL) || dlerror())
+      Dynamic = (DynamicFn) ModelLibraryRegistry::getSymbol(dynamicHinstance, kernelInfo->dynamic_symbol);
+      DynamicSparse = kernelInfo->dynamic_sparse_symbol == NULL ? NULL
+        : (DynamicSparseFn) ModelLibraryRegistry::getSymbol(dynamicHinstance, kernelInfo->dynamic_sparse_symbol);
+      DynamicSparsePattern = kernelInfo->dynamic_sparse_pattern_symbol == NULL ? NULL
+        : (DynamicSparsePatternFn) ModelLibraryRegistry::getSymbol(dynamicHinstance, kernelInfo->dynamic_sparse_pattern_symbol);
+      if (Dynamic == NULL)
         {
-          dlclose(dynamicHinstance); // Free the library
-          cerr << dlerror() << endl;
-          throw 2;
+          registry.release(dynamicHinstance);
+          throw TSException(__FILE__, __LINE__, "Can't locate the dynamic function in the kernel of " + basename);
         }
-#endif
-
-    }
-  catch (int i)
-    {
-      std::ostringstream msg;
-      msg << "Error when loading " << fName << " (";
-      if (i == 1)
-        msg << "can't dynamically load the file";
-      if (i == 2)
-        msg << "can't locate the 'Dynamic' symbol";
-      msg << ")";
-      throw TSException(__FILE__, __LINE__, msg.str());
+      if (DynamicSparsePattern == NULL)
+        DynamicSparse = NULL;
+      return;
     }
-  catch (...)
+
+  std::string fName = ModelLibraryRegistry::modelFileName(basename, std::string("_dynamic") + MEXEXT);
+
+  // The library is loaded only once per process
+  dynamicHinstance = registry.acquire(fName);
+
+  Dynamic = (DynamicFn) ModelLibraryRegistry::getSymbol(dynamicHinstance, "Dynamic");
+  if (Dynamic == NULL)
     {
-      throw TSException(__FILE__, __LINE__, std::string("Can't find Dynamic function in ") + fName);
+      registry.release(dynamicHinstance);
+      throw TSException(__FILE__, __LINE__, "Error when loading " + fName + " (can't locate the 'Dynamic' symbol)");
     }
+
+  // Optional symbols; the sparse mode needs both entry points
+  DynamicSparse = (DynamicSparseFn) ModelLibraryRegistry::getSymbol(dynamicHinstance, "DynamicSparse");
+  DynamicSparsePattern = (DynamicSparsePatternFn) ModelLibraryRegistry::getSymbol(dynamicHinstance, "DynamicSparsePattern");
+  if (DynamicSparsePattern == NULL)
+    DynamicSparse = NULL;
+}
+
+void
+DynamicModelDLL::getSparsePattern(CSCMatrix &g1) const throw (TSException)
+{
+  assert(DynamicSparsePattern != NULL);
+  const int *colptr, *rowind;
+  int ncols = DynamicSparsePattern(&colptr, &rowind);
+  setSparsePattern(g1, ncols, colptr, rowind);
+}
+
+void
+DynamicModelDLL::setSparsePattern(CSCMatrix &g1, int ncols, const int *colptr, const int *rowind) throw (TSException)
+{
+  if (ncols < 0 || (size_t) ncols != g1.getCols())
+    throw TSException(__FILE__, __LINE__, "Sparse jacobian of the dynamic DLL has a wrong number of columns");
+  if (colptr == NULL || colptr[0] != 0)
+    throw TSException(__FILE__, __LINE__, "Sparse jacobian of the dynamic DLL: the first column pointer must be 0");
+  for (int j = 0; j < ncols; j++)
+    if (colptr[j+1] < colptr[j] || (size_t) (colptr[j+1] - colptr[j]) > g1.getRows())
+      throw TSException(__FILE__, __LINE__, "Sparse jacobian of the dynamic DLL: inconsistent column pointers");
+
+  // colptr[ncols] is the number of nonzero elements
+  size_t nnz = colptr[ncols];
+  if (nnz > 0 && rowind == NULL)
+    throw TSException(__FILE__, __LINE__, "Sparse jacobian of the dynamic DLL has no row indices");
+  for (int j = 0; j < ncols; j++)
+    for (int k = colptr[j]; k < colptr[j+1]; k++)
+      {
+        if (rowind[k] < 0 || (size_t) rowind[k] >= g1.getRows())
+          throw TSException(__FILE__, __LINE__, "Sparse jacobian of the dynamic DLL has a wrong number of rows");
+        if (k > colptr[j] && rowind[k] <= rowind[k-1])
+          throw TSException(__FILE__, __LINE__, "Sparse jacobian of the dynamic DLL: row indices must be increasing within each column");
+      }
+
+  std::vector<size_t> colPtr(colptr, colptr + ncols + 1), rowInd(rowind, rowind + nnz);
+  g1.setPattern(colPtr, rowInd);
 }
 
 DynamicModelDLL::~DynamicModelDLL()
 {
-#if defined(__CYGWIN32__) || defined(_WIN32)
-  bool result = FreeLibrary(dynamicHinstance);
-  if (result == 0)
-    throw TSException(__FILE__, __LINE__, std::string("Can't free the *_dynamic DLL"));
-#else
-  dlclose(dynamicHinstance);
-#endif
+  ModelLibraryRegistry::instance().release(dynamicHinstance);
 }
@@ -17,24 +17,29 @@
  * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#if defined(_WIN32) || defined(__CYGWIN32__)
-# ifndef NOMINMAX
-#  define NOMINMAX // Do not define "min" and "max" macros
-# endif
-# include <windows.h>
-#else
-# include <dlfcn.h> // unix/linux DLL (.so) handling routines
-#endif
+#ifndef DYNAMIC_DLL_HH
+#define DYNAMIC_DLL_HH
 
 #include <string>
 #include "Matrix.hh"
+#include "SparseMatrix.hh"
 
 #include "ts_exception.h"
+#include "model_library.hh"
 
 // <model>_Dynamic DLL pointer
 typedef void (*DynamicFn)(const double *y, const double *x, int nb_row_x, const double *params, const double *steady_state,
                           int it_, double *residual, double *g1, double *g2, double *g3);
 
+// Optional entry points of <model>_dynamic DLL, for a jacobian in sparse (CSC) format:
+// the first one only fills the nonzero values of the jacobian,
+// the second one returns the number of columns, and the column pointers and row indices (0-based) of the sparsity pattern.
+// The Dynare preprocessor does not emit them: they are only found in hand-written DLLs and in kernels
+// (see dynare_model_kernel.h) produced by other code generators
+typedef void (*DynamicSparseFn)(const double *y, const double *x, int nb_row_x, const double *params, const double *steady_state,
+                                int it_, double *residual, double *g1_values);
+typedef int (*DynamicSparsePatternFn)(const int **colptr, const int **rowind);
+
 /**
  * creates pointer to Dynamic function inside <model>_dynamic.dll
  * and handles calls to it.
@@ -43,11 +48,10 @@ class DynamicModelDLL
 {
 private:
   DynamicFn Dynamic; // pointer to the Dynamic function in DLL
-#if defined(_WIN32) || defined(__CYGWIN32__)
-  HINSTANCE dynamicHinstance;  // DLL instance pointer in Windows
-#else
-  void *dynamicHinstance; // and in Linux or Mac
-#endif
+  DynamicSparseFn DynamicSparse; // NULL if the DLL does not provide a sparse jacobian
+  DynamicSparsePatternFn DynamicSparsePattern;
+  const dynare_model_kernel_info *kernelInfo; // NULL if the MEX file is used
+  LibraryHandle dynamicHinstance; // shared with other instances, see ModelLibraryRegistry
 
 public:
   // construct and load Dynamic model DLL
@@ -55,6 +59,43 @@ public:
   virtual
   ~DynamicModelDLL();
 
+  //! description of the plain kernel, or NULL if the model is loaded from the MEX file
+  const dynare_model_kernel_info *
+  getKernelInfo() const
+  {
+    return kernelInfo;
+  };
+
+  //! whether the DLL can compute the jacobian in sparse format
+  bool
+  hasSparseJacobian() const
+  {
+    return DynamicSparse != NULL;
+  };
+
+  //! set the sparsity pattern of the jacobian, as declared by the DLL
+  void getSparsePattern(CSCMatrix &g1) const throw (TSException);
+
+  //! set the sparsity pattern of g1 from the arrays returned by DynamicSparsePattern, after checking their consistency
+  static void setSparsePattern(CSCMatrix &g1, int ncols, const int *colptr, const int *rowind) throw (TSException);
+
+  //! evaluate Dynamic model DLL, with jacobian in sparse format (whose pattern must have been set by getSparsePattern())
+  template<class Vec1, class Vec2, class Vec3, class Vec4, class Mat1>
+  void
+  evalSparse(const Vec1 &y, const Mat1 &x, const Vec2 &modParams, const Vec3 &ySteady,
+             Vec4 &residual, CSCMatrix &g1) throw (TSException)
+  {
+    assert(DynamicSparse != NULL);
+    assert(y.getStride() == 1);
+    assert(x.getLd() == x.getRows());
+    assert(modParams.getStride() == 1);
+    assert(ySteady.getStride() == 1);
+    assert(residual.getStride() == 1);
+
+    DynamicSparse(y.getData(), x.getData(), 1, modParams.getData(), ySteady.getData(), 0, residual.getData(),
+                  g1.getValues());
+  };
+
   //! evaluate Dynamic model DLL
   template<class Vec1, class Vec2, class Vec3, class Vec4, class Mat1>
   void
@@ -66,11 +107,44 @@ public:
     assert(modParams.getStride() == 1);
     assert(ySteady.getStride() == 1);
     assert(residual.getStride() == 1);
-    assert(g1->getLd() == g1->getRows());
-    assert(g2->getLd() == g2->getRows());
-    assert(g3->getLd() == g3->getRows());
+    assert(g1 == NULL || g1->getLd() == g1->getRows());
+    assert(g2 == NULL || g2->getLd() == g2->getRows());
+    assert(g3 == NULL || g3->getLd() == g3->getRows());
 
     Dynamic(y.getData(), x.getData(), 1, modParams.getData(), ySteady.getData(), 0, residual.getData(),
             g1 == NULL ? NULL : g1->getData(), g2 == NULL ? NULL : g2->getData(), g3 == NULL ? NULL : g3->getData());
   };
+
+  /**
+   * evaluate Dynamic model DLL at points [first, last) of a batch, with one call to the DLL per point
+   *
+   * Compared to calls to eval(), there is no copy of the points: the DLL reads the exogenous variables
+   * of point p in row p of X, as it does for the periods of a simulation.
+   * \param[in] Y Column p holds the endogenous variables of point p (in the order of the jacobian columns)
+   * \param[in] X Row p holds the exogenous variables of point p; the whole matrix is passed to the DLL (nb_row_x = number of rows, it_ = p)
+   * \param[out] residuals Column p receives the residuals at point p
+   * \param[out] g1 If not NULL, the jacobian at point p is stored in columns [p*n, (p+1)*n) of g1, where n = Y.getRows()+X.getCols()
+   *
+   * The DLL functions generated by the preprocessor have no internal state, so disjoint ranges of the same batch can be evaluated concurrently.
+   */
+  template<class Mat1, class Mat2, class Vec1, class Vec2, class Mat3>
+  void
+  evalPoints(const Mat1 &Y, const Mat2 &X, const Vec1 &modParams, const Vec2 &ySteady,
+             Mat3 &residuals, Matrix *g1, size_t first, size_t last) throw (TSException)
+  {
+    size_t nJacobianCols = Y.getRows() + X.getCols();
+    assert(last <= Y.getCols() && last <= X.getRows() && last <= residuals.getCols());
+    assert(X.getLd() == X.getRows());
+    assert(modParams.getStride() == 1);
+    assert(ySteady.getStride() == 1);
+    assert(g1 == NULL || (g1->getLd() == g1->getRows() && g1->getRows() == residuals.getRows()
+                          && g1->getCols() >= last*nJacobianCols));
+
+    for (size_t p = first; p < last; p++)
+      Dynamic(Y.getData() + p*Y.getLd(), X.getData(), (int) X.getRows(), modParams.getData(), ySteady.getData(), (int) p,
+              residuals.getData() + p*residuals.getLd(),
+              g1 == NULL ? NULL : g1->getData() + p*nJacobianCols*g1->getLd(), NULL, NULL);
+  };
 };
+
+#endif
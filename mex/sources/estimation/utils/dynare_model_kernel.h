@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * C interface of plain model kernels.
+ *
+ * A model kernel is a plain shared library (not a MEX file), named
+ * <basename>_kernel.so (.dylib under macOS, .dll under Windows), containing
+ * the static and dynamic model functions. Since it does not depend on the
+ * MATLAB/Octave runtime, it can be compiled with any flags, e.g.:
+ *
+ *   gcc -O3 -march=native -flto -fPIC -shared -o fs2000_kernel.so fs2000_kernel.c
+ *
+ * and used by the estimation code in processes which do not run MATLAB or
+ * Octave. When a kernel is present, it takes precedence over the
+ * <basename>_dynamic and <basename>_static MEX files.
+ *
+ * The kernel must export a function named "dynare_model_kernel_get_info",
+ * which returns a pointer to a statically allocated description of the
+ * kernel (a C function cannot share its name with the type of the
+ * description). The first field of the description is the version of this interface: a kernel
+ * whose version differs from DYNARE_MODEL_KERNEL_ABI_VERSION is rejected, so
+ * fields can be added in later versions.
+ */
+
+#ifndef DYNARE_MODEL_KERNEL_H
+#define DYNARE_MODEL_KERNEL_H
+
+#define DYNARE_MODEL_KERNEL_ABI_VERSION 1
+#define DYNARE_MODEL_KERNEL_INFO_SYMBOL "dynare_model_kernel_get_info"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  typedef struct
+  {
+    /* Must be equal to DYNARE_MODEL_KERNEL_ABI_VERSION */
+    int abi_version;
+    /* Numbers of endogenous variables, exogenous variables and parameters */
+    int endo_nbr, exo_nbr, param_nbr;
+    /* Number of columns of the jacobian of the dynamic model (lagged, current
+       and leaded endogenous variables, then exogenous variables) */
+    int dynamic_jacobian_cols;
+    /* Highest order of derivatives that the functions below can compute */
+    int derivative_order;
+    /* Names of the exported functions. The static and dynamic functions have
+       the same prototypes as the "Static" and "Dynamic" functions of the MEX
+       files; the sparse ones those of "DynamicSparse" and
+       "DynamicSparsePattern" (and can be NULL) */
+    const char *static_symbol;
+    const char *dynamic_symbol;
+    const char *dynamic_sparse_symbol;
+    const char *dynamic_sparse_pattern_symbol;
+  } dynare_model_kernel_info;
+
+  typedef const dynare_model_kernel_info *(*dynare_model_kernel_info_fn)(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
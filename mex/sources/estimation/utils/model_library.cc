@@ -0,0 +1,214 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "model_library.hh"
+
+#include <cassert>
+#include <cstdlib>
+
+#include <sstream>
+
+#include <sys/stat.h>
+
+ModelLibraryRegistry &
+ModelLibraryRegistry::instance()
+{
+  static ModelLibraryRegistry registry;
+  return registry;
+}
+
+ModelLibraryRegistry::ModelLibraryRegistry()
+{
+  pthread_mutex_init(&mutex, NULL);
+}
+
+ModelLibraryRegistry::~ModelLibraryRegistry()
+{
+  for (std::map<std::string, Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+    unload(it->second.handle);
+  pthread_mutex_destroy(&mutex);
+}
+
+LibraryHandle
+ModelLibraryRegistry::acquire(const std::string &fName) throw (TSException)
+{
+  pthread_mutex_lock(&mutex);
+
+  std::string path = canonicalPath(fName);
+  time_t mtime = modificationTime(path);
+  std::map<std::string, Entry>::iterator it = entries.find(path);
+  if (it != entries.end())
+    {
+      if (it->second.refCount > 0 || it->second.mtime == mtime)
+        {
+          it->second.refCount++;
+          LibraryHandle handle = it->second.handle;
+          pthread_mutex_unlock(&mutex);
+          return handle;
+        }
+      // The file was modified since it was loaded, and nobody uses it anymore
+      unload(it->second.handle);
+      entries.erase(it);
+    }
+
+#if defined(__CYGWIN32__) || defined(_WIN32)
+  LibraryHandle handle = LoadLibrary(path.c_str());
+  if (handle == NULL)
+    {
+      pthread_mutex_unlock(&mutex);
+      throw TSException(__FILE__, __LINE__, "Error when loading " + fName + " (can't dynamically load the file)");
+    }
+#else
+  LibraryHandle handle = dlopen(path.c_str(), RTLD_NOW);
+  if (handle == NULL)
+    {
+      const char *err = dlerror();
+      pthread_mutex_unlock(&mutex);
+      throw TSException(__FILE__, __LINE__, "Error when loading " + fName + " (can't dynamically load the file"
+                        + (err ? std::string(": ") + err : std::string()) + ")");
+    }
+#endif
+
+  Entry e = { handle, 1, mtime };
+  entries[path] = e;
+  pthread_mutex_unlock(&mutex);
+  return handle;
+}
+
+LibraryHandle
+ModelLibraryRegistry::acquireIfExists(const std::string &fName) throw (TSException)
+{
+  if (modificationTime(fName) == 0)
+    return NULL;
+  return acquire(fName);
+}
+
+void
+ModelLibraryRegistry::release(LibraryHandle handle)
+{
+  pthread_mutex_lock(&mutex);
+  for (std::map<std::string, Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+    if (it->second.handle == handle)
+      {
+        assert(it->second.refCount > 0);
+        it->second.refCount--;
+        break;
+      }
+  pthread_mutex_unlock(&mutex);
+}
+
+void *
+ModelLibraryRegistry::getSymbol(LibraryHandle handle, const char *name)
+{
+#if defined(__CYGWIN32__) || defined(_WIN32)
+  return (void *) GetProcAddress(handle, name);
+#else
+  void *sym = dlsym(handle, name);
+  dlerror(); // Clear the error state if the symbol is absent
+  return sym;
+#endif
+}
+
+size_t
+ModelLibraryRegistry::getNumLoaded()
+{
+  pthread_mutex_lock(&mutex);
+  size_t n = entries.size();
+  pthread_mutex_unlock(&mutex);
+  return n;
+}
+
+void
+ModelLibraryRegistry::unload(LibraryHandle handle)
+{
+#if defined(__CYGWIN32__) || defined(_WIN32)
+  FreeLibrary(handle);
+#else
+  dlclose(handle);
+#endif
+}
+
+time_t
+ModelLibraryRegistry::modificationTime(const std::string &fName)
+{
+  struct stat st;
+  if (stat(fName.c_str(), &st) != 0)
+    return 0;
+  return st.st_mtime;
+}
+
+std::string
+ModelLibraryRegistry::canonicalPath(const std::string &fName)
+{
+  if (modificationTime(fName) == 0)
+    return fName;
+
+#if defined(_WIN32)
+  char path[_MAX_PATH];
+  if (_fullpath(path, fName.c_str(), _MAX_PATH) == NULL)
+    return fName;
+  return path;
+#else
+  char *path = realpath(fName.c_str(), NULL);
+  if (path == NULL)
+    return fName;
+  std::string result(path);
+  free(path);
+  return result;
+#endif
+}
+
+std::string
+ModelLibraryRegistry::modelFileName(const std::string &basename, const std::string &suffix)
+{
+  std::string fName;
+#if !defined(__CYGWIN32__) && !defined(_WIN32)
+  if (basename[0] != '/')
+    fName = "./";
+#endif
+  return fName + basename + suffix;
+}
+
+LibraryHandle
+ModelLibraryRegistry::acquireKernel(const std::string &basename, const dynare_model_kernel_info *&info) throw (TSException)
+{
+  std::string fName = modelFileName(basename, std::string("_kernel") + SHARED_LIBRARY_EXT);
+  info = NULL;
+  LibraryHandle handle = acquireIfExists(fName);
+  if (handle == NULL)
+    return NULL;
+
+  dynare_model_kernel_info_fn infoFn = (dynare_model_kernel_info_fn) getSymbol(handle, DYNARE_MODEL_KERNEL_INFO_SYMBOL);
+  if (infoFn == NULL || (info = infoFn()) == NULL)
+    {
+      release(handle);
+      throw TSException(__FILE__, __LINE__, "Error when loading " + fName + " (can't locate the '"
+                        DYNARE_MODEL_KERNEL_INFO_SYMBOL "' symbol)");
+    }
+  if (info->abi_version != DYNARE_MODEL_KERNEL_ABI_VERSION)
+    {
+      release(handle);
+      std::ostringstream msg;
+      msg << "Error when loading " << fName << " (interface version " << info->abi_version
+          << ", expected " << DYNARE_MODEL_KERNEL_ABI_VERSION << ")";
+      info = NULL;
+      throw TSException(__FILE__, __LINE__, msg.str());
+    }
+  return handle;
+}
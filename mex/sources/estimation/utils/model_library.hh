@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MODEL_LIBRARY_HH
+#define MODEL_LIBRARY_HH
+
+#if defined(_WIN32) || defined(__CYGWIN32__)
+# ifndef NOMINMAX
+#  define NOMINMAX // Do not define "min" and "max" macros
+# endif
+# include <windows.h>
+#else
+# include <dlfcn.h> // unix/linux DLL (.so) handling routines
+#endif
+
+#include <ctime>
+#include <map>
+#include <string>
+
+#include <pthread.h>
+
+#include "ts_exception.h"
+#include "dynare_model_kernel.h"
+
+#if defined(_WIN32) || defined(__CYGWIN32__)
+typedef HINSTANCE LibraryHandle; // DLL instance pointer in Windows
+# define SHARED_LIBRARY_EXT ".dll"
+#else
+typedef void *LibraryHandle; // and in Linux or Mac
+# if defined(__APPLE__)
+#  define SHARED_LIBRARY_EXT ".dylib"
+# else
+#  define SHARED_LIBRARY_EXT ".so"
+# endif
+#endif
+
+/**
+ * Process-wide registry of the model libraries (<model>_dynamic,
+ * <model>_static...), keyed by canonical absolute path, so that each of them is
+ * loaded only once however many solver objects use it. Model files are named
+ * relative to the current directory, so the same name can designate
+ * different models across calls; libraries are also loaded by absolute path,
+ * since the dynamic loader would otherwise return the library previously
+ * loaded under the same relative name.
+ *
+ * Libraries are reference counted. A library which is no longer referenced
+ * stays loaded, so that the next MEX call does not pay again for loading and
+ * relocating it, unless its file has been modified in the meantime (i.e. the
+ * model has been recompiled), in which case it is reloaded. A modified file
+ * is not reloaded while the old library is still referenced.
+ *
+ * All libraries are unloaded when the registry is destroyed, i.e. when the
+ * MEX file is unloaded. The registry can be used from several threads.
+ **/
+class ModelLibraryRegistry
+{
+public:
+  static ModelLibraryRegistry &instance();
+
+  //! Returns the handle of a library, loading it if needed; the caller must call release() once done
+  LibraryHandle acquire(const std::string &fName) throw (TSException);
+  //! Same as acquire(), but returns NULL if the file does not exist (for optional model files)
+  LibraryHandle acquireIfExists(const std::string &fName) throw (TSException);
+  void release(LibraryHandle handle);
+  //! Looks up a symbol in a library, returns NULL if it is absent
+  static void *getSymbol(LibraryHandle handle, const char *name);
+  //! Number of libraries currently loaded
+  size_t getNumLoaded();
+
+  /*!
+    Looks for the plain kernel of a model (see dynare_model_kernel.h).
+    \return NULL if there is no kernel file; otherwise the handle of the kernel (to be released by the caller), and its description in info
+    Throws if the kernel can't be loaded, or is not compatible.
+  */
+  LibraryHandle acquireKernel(const std::string &basename, const dynare_model_kernel_info *&info) throw (TSException);
+
+  //! Name of a file of the model, relative to the current directory unless basename is absolute
+  static std::string modelFileName(const std::string &basename, const std::string &suffix);
+
+private:
+  struct Entry
+  {
+    LibraryHandle handle;
+    size_t refCount;
+    time_t mtime;
+  };
+  std::map<std::string, Entry> entries; // Keyed by canonicalPath()
+  pthread_mutex_t mutex;
+
+  ModelLibraryRegistry();
+  ~ModelLibraryRegistry();
+  static void unload(LibraryHandle handle);
+  static time_t modificationTime(const std::string &fName);
+  //! Canonical absolute path of a file, or fName itself if the file can't be found (e.g. a system library found by the dynamic loader)
+  static std::string canonicalPath(const std::string &fName);
+  // Not copyable
+  ModelLibraryRegistry(const ModelLibraryRegistry &);
+  ModelLibraryRegistry &operator=(const ModelLibraryRegistry &);
+};
+
+#endif
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PHILOX_HH
+#define PHILOX_HH
+
+#include <cmath>
+#include <stdint.h>
+
+/**
+ * Counter-based random numbers: the Philox4x32-10 bijection of Salmon et al.,
+ * "Parallel random numbers: as easy as 1, 2, 3" (SC'11), maps a 128-bit
+ * counter and a 64-bit key to four 32-bit words which pass BigCrush.
+ *
+ * A PhiloxStream is keyed by a seed and a stream number (e.g. the purpose of
+ * the numbers), and the counter is made of a chain number, a 64-bit draw
+ * index and a block number within the draw. Any block can be computed
+ * independently of all the others, so that draws can be reproduced, or
+ * generated concurrently by several threads, without any shared state.
+ **/
+class PhiloxStream
+{
+public:
+  PhiloxStream(uint32_t seed_arg = 0, uint32_t stream_arg = 0) : seed(seed_arg), stream(stream_arg)
+  {
+  };
+
+  //! The bijection itself, exposed for known-answer tests
+  static void
+  bijection(const uint32_t ctr_in[4], const uint32_t key_in[2], uint32_t out[4])
+  {
+    uint32_t c0 = ctr_in[0], c1 = ctr_in[1], c2 = ctr_in[2], c3 = ctr_in[3];
+    uint32_t k0 = key_in[0], k1 = key_in[1];
+    for (int r = 0; r < 10; r++)
+      {
+        if (r > 0)
+          {
+            k0 += 0x9E3779B9;
+            k1 += 0xBB67AE85;
+          }
+        uint64_t p0 = (uint64_t) 0xD2511F53 * c0;
+        uint64_t p1 = (uint64_t) 0xCD9E8D57 * c2;
+        uint32_t n0 = (uint32_t) (p1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = (uint32_t) (p0 >> 32) ^ c3 ^ k1;
+        c0 = n0;
+        c1 = (uint32_t) p1;
+        c2 = n2;
+        c3 = (uint32_t) p0;
+      }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+  };
+
+  //! Four random words for a block of a draw of a chain
+  void
+  block(uint32_t chain, uint64_t index, uint32_t blockNumber, uint32_t out[4]) const
+  {
+    const uint32_t ctr[4] = { blockNumber, (uint32_t) index, (uint32_t) (index >> 32), chain };
+    const uint32_t key[2] = { seed, stream };
+    bijection(ctr, key, out);
+  };
+
+  //! Two uniform numbers in the open interval (0,1), with 53 random bits each
+  void
+  uniforms(uint32_t chain, uint64_t index, uint32_t blockNumber, double &u1, double &u2) const
+  {
+    uint32_t w[4];
+    block(chain, index, blockNumber, w);
+    u1 = toUniform(w[0], w[1]);
+    u2 = toUniform(w[2], w[3]);
+  };
+
+  //! Two independent standard normal numbers (Box-Muller transform of a block)
+  void
+  normals(uint32_t chain, uint64_t index, uint32_t blockNumber, double &z1, double &z2) const
+  {
+    double u1, u2;
+    uniforms(chain, index, blockNumber, u1, u2);
+    double r = sqrt(-2*log(u1));
+    z1 = r*cos(2*M_PI*u2);
+    z2 = r*sin(2*M_PI*u2);
+  };
+
+  /**
+   * Fills z[0..n) with the normal numbers of the blocks 0, 1, ... of a draw
+   * (the same numbers as successive calls to normals()). The uniform numbers
+   * are generated first, and the Box-Muller transform is then applied in a
+   * separate loop, which the compiler can vectorize.
+   */
+  void
+  fillNormals(uint32_t chain, uint64_t index, double *z, size_t n) const
+  {
+    const size_t pairs = n/2;
+    for (size_t b = 0; b < pairs; b++)
+      uniforms(chain, index, (uint32_t) b, z[2*b], z[2*b+1]);
+    for (size_t b = 0; b < pairs; b++)
+      {
+        double r = sqrt(-2*log(z[2*b])), t = 2*M_PI*z[2*b+1];
+        z[2*b] = r*cos(t);
+        z[2*b+1] = r*sin(t);
+      }
+    if (n % 2)
+      {
+        double unused;
+        normals(chain, index, (uint32_t) pairs, z[n-1], unused);
+      }
+  };
+
+private:
+  uint32_t seed, stream;
+
+  static double
+  toUniform(uint32_t a, uint32_t b)
+  {
+    // 53 bits from the two words, shifted by half a step to exclude 0 and 1
+    return (((uint64_t) (a >> 5) << 26 | (b >> 6)) + 0.5) * (1.0/9007199254740992.0);
+  };
+};
+
+#endif
@@ -19,72 +19,39 @@
 
 #include "static_dll.hh"
 
-#include <sstream>
-
-using namespace std;
-
 StaticModelDLL::StaticModelDLL(const std::string &basename) throw (TSException)
 {
-  std::string fName;
-#if !defined(__CYGWIN32__) && !defined(_WIN32)
-  if (basename[0] != '/')
-    fName = "./";
-#endif
-  fName += basename + "_static" + MEXEXT;
+  ModelLibraryRegistry &registry = ModelLibraryRegistry::instance();
 
-  try
+  // A plain kernel takes precedence over the MEX file
+  const dynare_model_kernel_info *kernelInfo;
+  staticHinstance = registry.acquireKernel(basename, kernelInfo);
+  if (staticHinstance != NULL)
     {
-#if defined(__CYGWIN32__) || defined(_WIN32)
-      staticHinstance = LoadLibrary(fName.c_str());
-      if (staticHinstance == NULL)
-        throw 1;
-      Static = (StaticFn) GetProcAddress(staticHinstance, "Static");
-      if (Static == NULL)
-        {
-          FreeLibrary(staticHinstance); // Free the library
-          throw 2;
-        }
-#else // Linux or Mac
-      staticHinstance = dlopen(fName.c_str(), RTLD_NOW);
-      if ((staticHinstance == NULL) || dlerror())
-        {
-          cerr << dlerror() << endl;
-          throw 1;
-        }
-      Static = (StaticFn) dlsym(staticHinstance, "Static");
-      if ((Static  == NULL) || dlerror())
+      Static = kernelInfo->static_symbol == NULL ? NULL
+        : (StaticFn) ModelLibraryRegistry::getSymbol(staticHinstance, kernelInfo->static_symbol);
+      if (Static == NULL || kernelInfo->derivative_order < 1)
         {
-          dlclose(staticHinstance); // Free the library
-          cerr << dlerror() << endl;
-          throw 2;
+          registry.release(staticHinstance);
+          throw TSException(__FILE__, __LINE__, "Can't locate the static function and its jacobian in the kernel of " + basename);
         }
-#endif
-
-    }
-  catch (int i)
-    {
-      std::ostringstream msg;
-      msg << "Error when loading " << fName << " (";
-      if (i == 1)
-        msg << "can't dynamically load the file";
-      if (i == 2)
-        msg << "can't locate the 'Static' symbol";
-      msg << ")";
-      throw TSException(__FILE__, __LINE__, msg.str());
+      return;
     }
-  catch (...)
+
+  std::string fName = ModelLibraryRegistry::modelFileName(basename, std::string("_static") + MEXEXT);
+
+  // The library is loaded only once per process
+  staticHinstance = registry.acquire(fName);
+
+  Static = (StaticFn) ModelLibraryRegistry::getSymbol(staticHinstance, "Static");
+  if (Static == NULL)
     {
-      throw TSException(__FILE__, __LINE__, std::string("Can't find Static function in ") + fName);
+      registry.release(staticHinstance);
+      throw TSException(__FILE__, __LINE__, "Error when loading " + fName + " (can't locate the 'Static' symbol)");
     }
 }
 
 StaticModelDLL::~StaticModelDLL()
 {
-#if defined(__CYGWIN32__) || defined(_WIN32)
-  bool result = FreeLibrary(staticHinstance);
-  if (result == 0)
-    throw TSException(__FILE__, __LINE__, std::string("Can't free the *_static DLL"));
-#else
-  dlclose(staticHinstance);
-#endif
+  ModelLibraryRegistry::instance().release(staticHinstance);
 }
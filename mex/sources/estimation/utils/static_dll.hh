@@ -17,19 +17,11 @@
  * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#if defined(_WIN32) || defined(__CYGWIN32__)
-# ifndef NOMINMAX
-#  define NOMINMAX // Do not define "min" and "max" macros
-# endif
-# include <windows.h>
-#else
-# include <dlfcn.h> // unix/linux DLL (.so) handling routines
-#endif
-
 #include <string>
 #include "Matrix.hh"
 
 #include "ts_exception.h"
+#include "model_library.hh"
 
 // Pointer to the Static function in the MEX
 typedef void (*StaticFn)(const double *y, const double *x, int nb_row_x, const double *params, double *residual, double *g1, double *v2);
@@ -42,11 +34,7 @@ class StaticModelDLL
 {
 private:
   StaticFn Static; // pointer to the Dynamic function in DLL
-#if defined(_WIN32) || defined(__CYGWIN32__)
-  HINSTANCE staticHinstance;  // DLL instance pointer in Windows
-#else
-  void *staticHinstance; // and in Linux or Mac
-#endif
+  LibraryHandle staticHinstance; // shared with other instances, see ModelLibraryRegistry
 
 public:
   // construct and load Static model DLL
@@ -64,8 +52,8 @@ public:
     assert(x.getLd() == x.getRows());
     assert(modParams.getStride() == 1);
     assert(residual.getStride() == 1);
-    assert(g1->getLd() == g1->getRows());
-    assert(v2->getLd() == v2->getRows());
+    assert(g1 == NULL || g1->getLd() == g1->getRows());
+    assert(v2 == NULL || v2->getLd() == v2->getRows());
 
     Static(y.getData(), x.getData(), 1, modParams.getData(), residual.getData(),
            g1 == NULL ? NULL : g1->getData(), v2 == NULL ? NULL : v2->getData());
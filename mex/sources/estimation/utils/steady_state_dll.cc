@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "steady_state_dll.hh"
+
+SteadyStateModelDLL::SteadyStateModelDLL(const std::string &basename) throw (TSException) :
+  SteadyState(NULL)
+{
+  std::string fName = ModelLibraryRegistry::modelFileName(basename, std::string("_steadystate") + MEXEXT);
+
+  ModelLibraryRegistry &registry = ModelLibraryRegistry::instance();
+  steadyStateHinstance = registry.acquireIfExists(fName);
+  if (steadyStateHinstance == NULL)
+    return;
+
+  SteadyState = (SteadyStateFn) ModelLibraryRegistry::getSymbol(steadyStateHinstance, "SteadyState");
+  if (SteadyState == NULL)
+    {
+      registry.release(steadyStateHinstance);
+      throw TSException(__FILE__, __LINE__, "Error when loading " + fName + " (can't locate the 'SteadyState' symbol)");
+    }
+}
+
+SteadyStateModelDLL::~SteadyStateModelDLL()
+{
+  if (steadyStateHinstance != NULL)
+    ModelLibraryRegistry::instance().release(steadyStateHinstance);
+}
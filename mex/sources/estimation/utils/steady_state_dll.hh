@@ -0,0 +1,70 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STEADY_STATE_DLL_HH
+#define STEADY_STATE_DLL_HH
+
+#include <cassert>
+#include <string>
+
+#include "ts_exception.h"
+#include "model_library.hh"
+
+// Pointer to the SteadyState function of the optional <model>_steadystate DLL:
+// computes the steady state in closed form, returns 0 on success, nonzero if it does not exist for these parameters
+typedef int (*SteadyStateFn)(const double *params, const double *x, double *steady_state);
+
+/**
+ * creates pointer to SteadyState function inside the optional <model>_steadystate.dll
+ * and handles calls to it.
+ **/
+class SteadyStateModelDLL
+{
+private:
+  SteadyStateFn SteadyState; // NULL if the model has no steady state DLL
+  LibraryHandle steadyStateHinstance; // shared with other instances, see ModelLibraryRegistry
+
+public:
+  // load the steady state DLL, if there is one
+  SteadyStateModelDLL(const std::string &basename) throw (TSException);
+  virtual
+  ~SteadyStateModelDLL();
+
+  //! whether the model has a steady state DLL
+  bool
+  isAvailable() const
+  {
+    return SteadyState != NULL;
+  };
+
+  //! evaluate SteadyState DLL, returns false if it failed
+  template<class Vec1, class Vec2, class Mat1>
+  bool
+  eval(const Vec1 &modParams, const Mat1 &x, Vec2 &steadyState)
+  {
+    assert(SteadyState != NULL);
+    assert(modParams.getStride() == 1);
+    assert(x.getLd() == x.getRows());
+    assert(steadyState.getStride() == 1);
+
+    return SteadyState(modParams.getData(), x.getData(), steadyState.getData()) == 0;
+  };
+};
+
+#endif
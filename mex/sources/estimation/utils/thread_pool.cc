@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "thread_pool.hh"
+
+#if defined(_WIN32)
+# ifndef NOMINMAX
+#  define NOMINMAX
+# endif
+# include <windows.h>
+#else
+# include <unistd.h>
+#endif
+
+ThreadPool::ThreadPool(size_t nWorkers_arg) throw (TSException) :
+  nWorkers(nWorkers_arg), task(NULL), nItems(0), nextItem(0), nRunning(0),
+  generation(0), failed(false), shutdown(false)
+{
+  TS_RAISE_IF(nWorkers == 0, "ThreadPool needs at least one worker");
+
+  pthread_mutex_init(&mutex, NULL);
+  pthread_cond_init(&workAvailable, NULL);
+  pthread_cond_init(&workDone, NULL);
+
+  // Worker 0 is the calling thread
+  threads.resize(nWorkers - 1);
+  threadArgs.resize(nWorkers - 1);
+  for (size_t i = 0; i < nWorkers - 1; i++)
+    {
+      threadArgs[i].pool = this;
+      threadArgs[i].worker = i + 1;
+      if (pthread_create(&threads[i], NULL, threadMain, &threadArgs[i]) != 0)
+        {
+          // Stop the threads already created
+          pthread_mutex_lock(&mutex);
+          shutdown = true;
+          pthread_cond_broadcast(&workAvailable);
+          pthread_mutex_unlock(&mutex);
+          for (size_t j = 0; j < i; j++)
+            pthread_join(threads[j], NULL);
+          throw TSException(__FILE__, __LINE__, "Can't create thread");
+        }
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+  pthread_mutex_lock(&mutex);
+  shutdown = true;
+  pthread_cond_broadcast(&workAvailable);
+  pthread_mutex_unlock(&mutex);
+
+  for (size_t i = 0; i < threads.size(); i++)
+    pthread_join(threads[i], NULL);
+
+  pthread_cond_destroy(&workDone);
+  pthread_cond_destroy(&workAvailable);
+  pthread_mutex_destroy(&mutex);
+}
+
+void
+ThreadPool::run(Task &task_arg, size_t nItems_arg) throw (TSException)
+{
+  pthread_mutex_lock(&mutex);
+  task = &task_arg;
+  nItems = nItems_arg;
+  nextItem = 0;
+  failed = false;
+  nRunning = threads.size();
+  generation++;
+  pthread_cond_broadcast(&workAvailable);
+  pthread_mutex_unlock(&mutex);
+
+  work(0);
+
+  pthread_mutex_lock(&mutex);
+  while (nRunning > 0)
+    pthread_cond_wait(&workDone, &mutex);
+  task = NULL;
+  bool failed_copy = failed;
+  pthread_mutex_unlock(&mutex);
+
+  TS_RAISE_IF(failed_copy, "Uncaught exception in a task of the thread pool");
+}
+
+void
+ThreadPool::work(size_t worker)
+{
+  while (true)
+    {
+      pthread_mutex_lock(&mutex);
+      if (nextItem >= nItems)
+        {
+          pthread_mutex_unlock(&mutex);
+          return;
+        }
+      size_t item = nextItem++;
+      Task *t = task;
+      pthread_mutex_unlock(&mutex);
+
+      try
+        {
+          t->run(item, worker);
+        }
+      catch (...)
+        {
+          pthread_mutex_lock(&mutex);
+          failed = true;
+          pthread_mutex_unlock(&mutex);
+        }
+    }
+}
+
+void *
+ThreadPool::threadMain(void *arg)
+{
+  ThreadArg *ta = (ThreadArg *) arg;
+  ThreadPool *pool = ta->pool;
+  unsigned long seen = 0;
+
+  while (true)
+    {
+      pthread_mutex_lock(&pool->mutex);
+      while (!pool->shutdown && pool->generation == seen)
+        pthread_cond_wait(&pool->workAvailable, &pool->mutex);
+      if (pool->shutdown)
+        {
+          pthread_mutex_unlock(&pool->mutex);
+          return NULL;
+        }
+      seen = pool->generation;
+      pthread_mutex_unlock(&pool->mutex);
+
+      pool->work(ta->worker);
+
+      pthread_mutex_lock(&pool->mutex);
+      if (--pool->nRunning == 0)
+        pthread_cond_signal(&pool->workDone);
+      pthread_mutex_unlock(&pool->mutex);
+    }
+}
+
+size_t
+ThreadPool::defaultNumWorkers()
+{
+#if defined(_WIN32)
+  SYSTEM_INFO info;
+  GetSystemInfo(&info);
+  long n = info.dwNumberOfProcessors;
+#else
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+  return n > 0 ? (size_t) n : 1;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2017 Dynare Team
+ *
+ * This file is part of Dynare.
+ *
+ * Dynare is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Dynare is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Dynare.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THREAD_POOL_HH
+#define THREAD_POOL_HH
+
+#include <cstdlib>
+#include <vector>
+
+#include <pthread.h>
+
+#include "ts_exception.h"
+
+/**
+ * A fixed set of POSIX threads, which repeatedly execute a task over a range
+ * of items. The thread calling run() takes part in the work as worker 0, so a
+ * pool of size 1 does not create any thread and runs everything serially.
+ *
+ * Items are handed out one at a time, so the assignment of items to workers
+ * is not deterministic: a task must only use the worker index to select a
+ * per-worker workspace, and must store its results per item.
+ **/
+class ThreadPool
+{
+public:
+  class Task
+  {
+  public:
+    virtual ~Task()
+    {
+    };
+    //! Processes an item; must not access the MATLAB/Octave API, since it may not run in the main thread
+    virtual void run(size_t item, size_t worker) = 0;
+  };
+
+  //! Creates nWorkers-1 threads (nWorkers must be at least 1)
+  ThreadPool(size_t nWorkers_arg) throw (TSException);
+  virtual ~ThreadPool();
+
+  size_t
+  getNumWorkers() const
+  {
+    return nWorkers;
+  };
+
+  //! Calls task.run(i, worker) for every i in [0, nItems), and waits for completion
+  /*! Throws if the task threw an exception for some item (after all items have been processed) */
+  void run(Task &task, size_t nItems) throw (TSException);
+
+  //! Number of workers to use by default: the number of online processors
+  static size_t defaultNumWorkers();
+
+private:
+  struct ThreadArg
+  {
+    ThreadPool *pool;
+    size_t worker;
+  };
+
+  const size_t nWorkers;
+  std::vector<pthread_t> threads;
+  std::vector<ThreadArg> threadArgs;
+  pthread_mutex_t mutex;
+  pthread_cond_t workAvailable, workDone;
+
+  // The fields below are protected by mutex
+  Task *task;
+  size_t nItems, nextItem;
+  //! Number of threads which have not yet finished the current generation of work
+  size_t nRunning;
+  //! Incremented by every call to run()
+  unsigned long generation;
+  bool failed, shutdown;
+
+  static void *threadMain(void *arg);
+  //! Processes items of the current task until there are none left
+  void work(size_t worker);
+
+  // Not copyable
+  ThreadPool(const ThreadPool &);
+  ThreadPool &operator=(const ThreadPool &);
+};
+
+#endif